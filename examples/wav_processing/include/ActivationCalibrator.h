@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AudioModel.h"
+#include "BasicTypes.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace WS
+{
+/// @brief Collects activation ranges of the model layers through AudioModel::getValidationValues(),
+/// and derives the symmetric int8 scales (absmax / 127) that a quantized run would need.
+/// Layer values are read as filterCnt channels of sampleCnt consecutive samples.
+class ActivationCalibrator
+{
+public:
+    /// @brief Layers tapped when no list is given.
+    static std::vector<std::string> const DefaultLayerNames;
+
+    ActivationCalibrator();
+    explicit ActivationCalibrator(std::vector<std::string> const& layerNames);
+
+    /// @brief Reads the layer values of the last AudioModel::process() call. Layers the model
+    /// does not expose are skipped.
+    void collect(AudioModel& model);
+
+    /// @brief Writes, per layer, the value range and the per-layer and per-channel int8 scales.
+    void writeReport(std::ostream& os) const;
+
+    u64 getFrameCnt() const;
+
+private:
+    struct LayerRange
+    {
+        std::string name;
+        size_t filterCnt{0};
+        size_t sampleCnt{0};
+        float minValue{0.0F};
+        float maxValue{0.0F};
+        std::vector<float> channelAbsMax;
+        u64 frameCnt{0};
+    };
+
+    // Data members
+private:
+    std::vector<LayerRange> mLayers;
+    u64 mFrameCnt{0};
+};
+
+} // namespace WS
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "BasicTypes.h"
+
+namespace WS
+{
+/// @brief Debug check that the scope it lives in makes no heap allocation on the calling thread.
+/// Allocations are counted by the global operator new replaced in debug builds; release builds
+/// compile the guard away. Calls into the AudioModel are wrapped in an Excluded scope, since the
+/// engine allocations are outside the control of the host.
+class AllocationGuard
+{
+public:
+    /// @brief Allocations made while an Excluded scope is alive are not counted.
+    class Excluded
+    {
+    public:
+#ifndef NDEBUG
+        Excluded();
+        ~Excluded();
+#else
+        Excluded() {}
+#endif
+        Excluded(const Excluded&) = delete;
+        Excluded& operator=(const Excluded&) = delete;
+    };
+
+#ifndef NDEBUG
+    AllocationGuard();
+    ~AllocationGuard();
+
+    /// @brief Number of counted allocations made by the calling thread so far.
+    static u64 getAllocationCnt();
+
+private:
+    u64 const mStartCnt;
+#else
+    AllocationGuard() {}
+#endif
+
+public:
+    AllocationGuard(const AllocationGuard&) = delete;
+    AllocationGuard& operator=(const AllocationGuard&) = delete;
+};
+
+} // namespace WS
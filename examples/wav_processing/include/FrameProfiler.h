@@ -0,0 +1,94 @@
+#pragma once
+
+#include "BasicTypes.h"
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace WS
+{
+/// @brief Times the stages of the per-frame processing: call counts, total / min / max time and
+/// p50 / p99 from a fixed log-linear histogram (about 12% resolution, no allocation when recording).
+/// When disabled, a Scope costs a single branch. Recording is not thread-safe: callers serialize it,
+/// as SharedModel does with its model lock.
+class FrameProfiler
+{
+public:
+    enum class Section : u8
+    {
+        ApplyParams,
+        ModelProcess,
+        OverlapAdd,
+        WavRead,
+        WavWrite,
+        Count
+    };
+
+    struct SectionStats
+    {
+        std::string name;
+        u64 callCnt;
+        double totalMs;
+        double minMs;
+        double maxMs;
+        double p50Ms;
+        double p99Ms;
+    };
+
+    /// @brief Times the lifetime of the scope into the given section of profiler, if enabled.
+    class Scope
+    {
+    public:
+        Scope(FrameProfiler* profiler, Section section);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler* const mProfiler;
+        Section const mSection;
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+    FrameProfiler();
+
+    void enableProfiling(bool enable);
+    bool isEnabled() const;
+
+    /// @brief Clears all recorded times.
+    void reset();
+
+    void record(Section section, std::chrono::nanoseconds duration);
+
+    /// @brief Returns the stats of every section called at least once.
+    std::vector<SectionStats> getStats() const;
+
+    static char const* getSectionName(Section section);
+
+private:
+    /// Histogram buckets: 8 linear sub-buckets per power of two of nanoseconds.
+    static constexpr u32 SubBucketBits{3U};
+    static constexpr u32 BucketCnt{(64U - SubBucketBits + 1U) << SubBucketBits};
+
+    struct SectionData
+    {
+        u64 callCnt;
+        u64 totalNs;
+        u64 minNs;
+        u64 maxNs;
+        std::array<u32, BucketCnt> histogram;
+    };
+
+    static u32 toBucket(u64 ns);
+    static u64 fromBucket(u32 bucket);
+    static double getPercentileMs(SectionData const& data, double percentile);
+
+    // Data members
+private:
+    bool mEnabled{false};
+    std::array<SectionData, static_cast<size_t>(Section::Count)> mSections;
+};
+
+} // namespace WS
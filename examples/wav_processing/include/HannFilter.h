@@ -1,5 +1,11 @@
+#pragma once
+
 #include "AudioModel.h"
 #include "BasicTypes.h"
+#include "FrameProfiler.h"
+#include "SimdKernels.h"
+#include "WorkerPool.h"
+#include <atomic>
 #include <memory>
 
 namespace WS
@@ -7,8 +13,17 @@ namespace WS
 class HannFilter
 {
 public:
+    /// @brief Called after each model call of processHop(), with the model that ran it, while the layer values
+    /// of that call can still be read with AudioModel::getValidationValues().
+    using ModelCallback = void (*)(void* userData, AudioModel& model);
+
     HannFilter(u32 const filterWindowSize);
 
+    /// @brief Creates a filter advancing by hopSize samples per model call.
+    /// @param filterWindowSize the model frame length
+    /// @param hopSize the number of new samples per model call, must divide filterWindowSize and be at most half of it
+    HannFilter(u32 const filterWindowSize, u32 const hopSize);
+
     /// @brief Receives a buffer of "filterWindowSize" containing the samples to be filtered.
     /// @brief Will return then Hann filtered data, in outSamples, processed with the given model.
     /// @param dataSamples a float buffer "filterWindowSize" "filterWindowSize" samples
@@ -18,19 +33,75 @@ public:
     /// @return success / failed
     bool applyFilter(float* dataSamples, u32 sampleCnt, AudioModel& model, float* outSamples);
 
+    /// @brief Same as above, with the "filterWindowSize / hopSize" model calls of the block spread over the pool.
+    /// The windows of a block only depend on the input samples, so they are built first, processed in
+    /// parallel, then overlap-added in order.
+    /// @param models one model per pool thread, models[threadIdx] is only used by that thread
+    /// @param pool the threads to run the model calls on
+    /// @return success / failed, also when one of the model calls failed: nothing is then overlap-added
+    bool applyFilter(float* dataSamples, u32 sampleCnt, AudioModel* const* models, WorkerPool& pool, float* outSamples);
+
+    /// @brief Streams a single hop: the last "filterWindowSize - hopSize" input samples are kept from the
+    /// previous hops, so only the "hopSize" new samples are given.
+    /// @param dataSamples a float buffer of "hopSize" samples
+    /// @param model the actual model to use for processing
+    /// @param outSamples an output buffer allocated for "hopSize" samples.
+    /// @return success / failed, also when the model call failed
+    bool processHop(float* dataSamples, AudioModel& model, float* outSamples);
+
+    /// @brief Times the model calls and the overlap-add into the given profiler, nullptr to stop.
+    void setProfiler(FrameProfiler* profiler);
+
+    /// @brief Sets the callback run after every model call of processHop(), nullptr to stop.
+    /// It is not run by the parallel applyFilter(), whose model calls are spread over the pool threads.
+    void setModelCallback(ModelCallback callback, void* userData);
+    bool hasModelCallback() const;
+
+    u32 getWindowSize() const;
+    u32 getHopSize() const;
+
 private:
-    bool applyFilterInternal(float* dataSamples, u32 sampleCnt, AudioModel& model, float* outSamples);
+    /// @brief Windows one model output into the overlap buffer and returns the completed hop.
+    void overlapAdd(const float* modelOutput, float* outSamples);
+
+    /// @brief WorkerPool task running the model on the window of one hop.
+    static void processWindowTask(void* userData, u32 hop, u32 threadIdx);
 
     // Data members
 private:
     u32 const mWindowSize;
     u32 const mHopSize;
 
-    /// @brief  Holds the output values, keeping the last values for next hop
-    std::unique_ptr<float> mOverlapBuffer;
+    /// @brief Overlap-add compensation of the Hann window for the hop size (1.0 at 50% overlap)
+    float const mOverlapGain;
+
+    /// @brief Hann window coefficients, overlap-add compensation included
+    std::unique_ptr<float[]> mWindow;
+
+    /// @brief Windowing and overlap-add kernel, picked for the running CPU
+    Simd::MultiplyAddFunc const mMultiplyAdd;
+
+    /// @brief  Holds the summed output values of the "filterWindowSize / hopSize" windows still in flight
+    std::unique_ptr<float[]> mOverlapBuffer;
 
     /// Declare and zero-fill the model input buffer
-    std::unique_ptr<float> mModelInputBuffer;
+    std::unique_ptr<float[]> mModelInputBuffer;
+
+    /// @brief Receives the model output of the current hop, allocated once
+    std::unique_ptr<float[]> mModelOutputBuffer;
+
+    /// @brief Model inputs and outputs of all the hops of one block, for the parallel applyFilter()
+    std::unique_ptr<float[]> mBlockInputs;
+    std::unique_ptr<float[]> mBlockOutputs;
+
+    /// @brief Models of the parallel applyFilter() call in progress, and whether one of its model calls failed
+    AudioModel* const* mBlockModels{nullptr};
+    std::atomic<bool> mBlockFailed{false};
+
+    FrameProfiler* mProfiler{nullptr};
+
+    ModelCallback mModelCallback{nullptr};
+    void* mModelCallbackData{nullptr};
 };
 
 } // namespace WS
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "BasicTypes.h"
+#include <string>
+
+namespace WS
+{
+/// @brief Single-file model: the header.dat topology and every N.dat weight file of a model folder,
+/// read and written in one go. This replaces the per-file opens and reads on slow or network-backed volumes.
+///
+/// Layout, little-endian:
+/// - 64-byte file header: magic "WSMP", format version, section count, header size
+/// - one 64-byte entry per section: file name (up to 39 characters), offset and size of its data
+/// - the section data, each section starting on a 64-byte boundary
+///
+/// AudioModel::prepare() only takes a model folder, so a package is extracted to a temporary folder
+/// that lives as long as the ModelPackage.
+class ModelPackage
+{
+public:
+    static constexpr u32 FormatVersion{1U};
+    static constexpr u32 Alignment{64U};
+
+    ModelPackage() = default;
+    ~ModelPackage();
+
+    ModelPackage(const ModelPackage&) = delete;
+    ModelPackage& operator=(const ModelPackage&) = delete;
+
+    /// @brief Returns whether path is a model package file, of a supported version.
+    static bool isPackage(std::string const& path);
+
+    /// @brief Writes every regular file of modelFolder into a new package.
+    /// @return success / failed
+    static bool pack(std::string const& modelFolder, std::string const& packagePath);
+
+    /// @brief Extracts the package into a new temporary folder, removed by the destructor.
+    /// @return success / failed, also when a section count, offset or size does not fit in the file
+    bool extract(std::string const& packagePath);
+
+    /// @brief The folder holding the extracted model files, empty until extract() succeeded.
+    std::string const& getFolder() const;
+
+private:
+    void removeFolder();
+
+    // Data members
+private:
+    std::string mFolder;
+};
+
+} // namespace WS
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "AudioModel.h"
+#include "BasicTypes.h"
+#include "SharedModel.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace WS
+{
+/// @brief Process-wide cache of prepared models, so that opening the same model again costs a lookup
+/// instead of the file reads and the preparation.
+/// Models are keyed by path, activation, sample rate and a hash of the model files, so an updated model
+/// on disk is prepared again. The files are only hashed again once their size or modification time changed. A model lives as long as one of its SharedModel references, or while pinned.
+/// Settings made on a SharedModel, as EQ or default parameter values, are seen by all its holders.
+class ModelRegistry
+{
+public:
+    static ModelRegistry& getInstance();
+
+    /// @brief Allocates and prepares a model on its own, out of the registry.
+    /// @param modelPath a model folder, or a file written by ModelPackage::pack()
+    /// @return the prepared model, nullptr on failure
+    static std::unique_ptr<AudioModel> prepareModel(std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// @brief Returns the prepared model, preparing it only if no holder or pin keeps it alive.
+    /// Preparation runs with the registry locked, so concurrent requests for a model prepare it once.
+    /// @return the shared model, nullptr if it could not be prepared
+    std::shared_ptr<SharedModel> acquire(std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// @brief Prepares the model if needed and keeps it alive until unpin(), with no holder.
+    /// @return success / failed
+    bool pin(std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// @brief Releases the pin: the model goes once its last holder releases it.
+    void unpin(std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// @brief Number of models currently alive.
+    size_t getModelCnt();
+
+private:
+    ModelRegistry() = default;
+
+    struct Entry
+    {
+        std::weak_ptr<SharedModel> model;
+        std::shared_ptr<SharedModel> pinned;
+    };
+
+    /// @brief Content hash of a model, kept while the size and modification time of its files are unchanged
+    struct FileHash
+    {
+        std::string fileStamps;
+        u64 hash{0};
+    };
+
+    /// @brief Key of a model, empty if its files cannot be read. Must be called with mMutex held.
+    std::string getKey(std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// Must be called with mMutex held.
+    std::shared_ptr<SharedModel> acquireLocked(std::string const& key, std::string const& modelPath, std::string const& activation, u32 sampleRate);
+
+    /// Must be called with mMutex held.
+    void removeReleased();
+
+    // Data members
+private:
+    std::mutex mMutex;
+    std::map<std::string, Entry> mEntries;
+    std::map<std::string, FileHash> mFileHashes;
+};
+
+} // namespace WS
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "BasicTypes.h"
+#include "Resampler.h"
+#include <functional>
+#include <memory>
+
+namespace WS
+{
+/// @brief Runs a fixed-block processing, as a model, at its own sample rate inside a stream at another rate.
+/// Each block of the stream is resampled to the processing rate, processed there in blocks of the same size
+/// as soon as enough samples are gathered, and resampled back. The output starts with silence, so that a whole
+/// block is always ready: getLatencySamples() gives the resulting delay.
+class RateAdapter
+{
+public:
+    /// @brief Processes blockSize samples at the processing rate, from in to out. Returns success / failed.
+    using BlockFunc = std::function<bool(float* in, float* out)>;
+
+    /// @param streamRate sample rate of the stream
+    /// @param processRate sample rate blockFunc runs at
+    /// @param blockSize samples per block, on both sides
+    /// @param processDelay delay of blockFunc itself, in samples at the processing rate
+    RateAdapter(u32 const streamRate, u32 const processRate, u32 const blockSize, u32 const processDelay, BlockFunc blockFunc);
+
+    /// @brief Processes one block of blockSize samples of the stream.
+    /// @return success / failed, also when blockFunc failed
+    bool process(const float* dataSamples, float* outSamples);
+
+    /// @brief Delay of the output behind the input, in samples at the stream rate, processDelay included.
+    u32 getLatencySamples() const;
+
+    // Data members
+private:
+    u32 const mBlockSize;
+    BlockFunc const mBlockFunc;
+
+    Resampler mInputResampler;
+    Resampler mOutputResampler;
+
+    /// @brief Samples at the processing rate waiting for a whole block
+    std::unique_ptr<float[]> mProcessInput;
+    u32 mProcessInputCnt{0};
+    std::unique_ptr<float[]> mProcessOutput;
+
+    /// @brief Samples back at the stream rate, not output yet
+    u32 const mStreamOutputCapacity;
+    std::unique_ptr<float[]> mStreamOutput;
+    u32 mStreamOutputCnt{0};
+
+    u32 mLatencySamples{0};
+};
+
+} // namespace WS
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "BasicTypes.h"
+#include "SimdKernels.h"
+#include <memory>
+
+namespace WS
+{
+/// @brief Streaming polyphase resampler for one channel, converting between any two integer rates.
+/// The rate ratio is reduced to outRate / inRate = L / M. The anti-aliasing filter is a Kaiser windowed sinc
+/// split in L phases of a few taps each. It spans only a handful of zero crossings to keep the delay under
+/// a millisecond at audio rates.
+class Resampler
+{
+public:
+    /// @param maxInputCnt largest number of samples given to a process() call
+    Resampler(u32 const inRate, u32 const outRate, u32 const maxInputCnt);
+
+    /// @brief Converts the next inCnt samples of the stream.
+    /// @param out an output buffer allocated for getMaxOutputCnt() samples
+    /// @param outCnt receives the number of samples written to out
+    /// @return success / failed, when inCnt is larger than maxInputCnt
+    bool process(const float* in, u32 inCnt, float* out, u32& outCnt);
+
+    u32 getMaxOutputCnt() const;
+
+    /// @brief Group delay of the filter, in input samples.
+    double getDelay() const;
+
+    // Data members
+private:
+    u32 const mUpFactor;
+    u32 const mDownFactor;
+    u32 const mMaxInputCnt;
+
+    /// @brief Taps per phase
+    u32 const mTapCnt;
+
+    /// @brief Coefficients of every phase, mTapCnt each, reversed to run along the input samples
+    std::unique_ptr<float[]> mCoeffs;
+
+    /// @brief The last mTapCnt - 1 input samples, followed by the samples of the current call
+    std::unique_ptr<float[]> mInput;
+
+    /// @brief Position of the next output sample: input sample mInputPos of the current call, phase mPhase
+    u32 mInputPos{0};
+    u32 mPhase{0};
+
+    Simd::DotProductFunc const mDotProduct;
+};
+
+} // namespace WS
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "AudioModel.h"
+#include "BasicTypes.h"
+#include "FrameProfiler.h"
+#include "HannFilter.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace WS
+{
+class SharedModel;
+
+/// @brief Index of a model parameter, in the order the parameters were added to the AudioModel
+using ParamId = size_t;
+
+/// @brief Per-stream state used with a SharedModel: the overlap-add window, its scratch buffers
+/// and the parameter values of the stream. A context is cheap to create and never holds model weights.
+/// State kept inside the AudioModel is not part of it: the EQ filter history, with an EQ loaded, is shared
+/// by all the contexts of a SharedModel, whose model calls interleave through it.
+class StreamContext
+{
+public:
+    StreamContext(u32 const frameLength, std::vector<float> const& paramValues);
+
+    /// @brief Publishes a new value of a parameter, for this stream only.
+    /// Lock-free: may be called from any thread, also while the stream is processing. SharedModel::process()
+    /// ramps from the previous value to the new one over its next block, one step per hop.
+    /// @param param Index of the parameter
+    /// @param value Float value to set (0.0 to 1.0 recommended)
+    void setParamValueAt(ParamId param, float value);
+
+    /// @brief Parameter values the last block was processed with. Only to be read from the processing thread.
+    std::vector<float> const& getParamValues() const;
+
+    /// @brief Runs callback after every model call of this stream, nullptr to stop. The blocks of a stream
+    /// with a callback run their hops in order on the first model, even when SharedModel::setNumThreads() is used.
+    void setModelCallback(HannFilter::ModelCallback callback, void* userData);
+
+    u32 getFrameLength() const;
+
+private:
+    /// @brief Reads the published values into mTargetParamValues, returns whether any differs from mParamValues.
+    bool loadTargetParamValues();
+
+    // Data members
+private:
+    u32 const mFrameLength;
+
+    /// @brief Overlap-add state of this stream
+    HannFilter mHannFilter;
+
+    /// @brief Values published by setParamValueAt()
+    std::unique_ptr<std::atomic<float>[]> mPublishedParamValues;
+
+    /// @brief Parameter values applied to the model before processing this stream
+    std::vector<float> mParamValues;
+
+    /// @brief Published values read at the start of a block, and the ramp step of the current hop
+    std::vector<float> mTargetParamValues;
+    std::vector<float> mHopParamValues;
+
+    friend class SharedModel;
+};
+
+/// @brief Holds one prepared AudioModel, and so one copy of its weights, for any number of streams.
+/// Each stream owns a StreamContext created by createContext(). process() may be
+/// called from several threads at once: calls into the AudioModel are serialized.
+/// Only the overlap-add and the parameter values are kept per stream. The EQ runs inside the AudioModel and
+/// keeps its filter history from one call to the next, whatever the stream: with an EQ loaded, the streams
+/// of a SharedModel, as the two channels of a file, run through one EQ history.
+class SharedModel
+{
+public:
+    /// @brief Creates a prepared model, with the same model file and settings as the shared one.
+    using ModelFactory = std::function<std::unique_ptr<AudioModel>()>;
+
+    /// @brief Takes ownership of an AudioModel on which prepare() already succeeded.
+    explicit SharedModel(std::unique_ptr<AudioModel> model);
+
+    /// @brief Sets the default value of a parameter, used by the contexts created afterwards.
+    /// Contexts already created keep their own values, which are the ones applied to the model.
+    void setParamValueAt(size_t param, float value);
+
+    /// @brief Loads the EQ of the model and of its replicas, for all the streams sharing them.
+    /// Its filter state is then shared by those streams too. Waits for the block being processed, if any.
+    /// @return success / failed
+    bool loadJsonEQParameters(std::string const& inJsonConfigPathName, int samplingRate);
+
+    std::unique_ptr<StreamContext> createContext();
+
+    /// @brief Processes one block of getFrameLength() samples for the stream owning context.
+    /// @param context the stream context, as returned by createContext()
+    /// @param dataSamples a float buffer of getFrameLength() samples
+    /// @param outSamples an output buffer allocated for getFrameLength() samples
+    /// @return success / failed
+    bool process(StreamContext& context, float* dataSamples, float* outSamples);
+
+    /// @brief Spreads the model calls of each process() block over numThreads threads, to lower the
+    /// latency of a single stream. Every thread past the first runs its own model replica, created with
+    /// factory, so the weights are held numThreads times. 1 turns the pool off and frees the replicas.
+    /// @return false if a replica could not be created, the previous setting is then kept
+    bool setNumThreads(u32 numThreads, ModelFactory const& factory);
+    u32 getNumThreads() const;
+
+    /// @brief Turns on or off the timing of the processing stages of every context.
+    /// Costs a single branch per stage when off.
+    void enableProfiling(bool enable);
+
+    /// @brief The profiler may only be read or reset while no stream is processing.
+    FrameProfiler& getProfiler();
+
+    size_t getFrameLength() const;
+    size_t getNumberOfParams() const;
+
+private:
+    /// @brief Processes a block while its parameters move to the published values. Hops run in order on mModel.
+    /// Must be called with mModelMutex held.
+    bool processRamp(StreamContext& context, float* dataSamples, float* outSamples);
+
+    /// Must be called with mModelMutex held. Only the values differing from the applied ones reach the models.
+    void applyParamValues(std::vector<float> const& paramValues);
+
+    // Data members
+private:
+    std::unique_ptr<AudioModel> mModel;
+    size_t const mFrameLength;
+
+    /// @brief Parameter values given to new contexts
+    std::vector<float> mDefaultParamValues;
+
+    /// @brief Parameter values the models were last conditioned with, valid if mAppliedParamsValid
+    std::vector<float> mAppliedParamValues;
+    bool mAppliedParamsValid{false};
+
+    /// @brief Model replicas of the pool threads 1..n, and the model of every pool thread, mModel first
+    std::vector<std::unique_ptr<AudioModel>> mReplicas;
+    std::vector<AudioModel*> mThreadModels;
+
+    /// @brief Threads of the intra-block split, nullptr when single-threaded
+    std::unique_ptr<WorkerPool> mWorkerPool;
+
+    /// @brief Serializes calls into mModel, and so the recording into mProfiler
+    std::mutex mModelMutex;
+
+    FrameProfiler mProfiler;
+};
+
+} // namespace WS
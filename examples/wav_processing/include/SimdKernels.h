@@ -0,0 +1,45 @@
+#pragma once
+
+#include "BasicTypes.h"
+
+namespace WS
+{
+namespace Simd
+{
+/// @brief Instruction sets for which kernels are available, from slowest to fastest.
+enum class Isa : u8
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+/// @brief acc[s] += samples[s] * window[s], for s in [0, sampleCnt)
+/// All the kernels round exactly like the scalar one, so results do not depend on the host. SimdKernels.cpp turns
+/// floating-point contraction off for this: an FMA would round the product and the sum only once.
+using MultiplyAddFunc = void (*)(float* acc, const float* samples, const float* window, u32 sampleCnt);
+
+/// @brief Returns the sum of a[s] * b[s], for s in [0, sampleCnt)
+/// Every kernel sums in the same order, over 16 interleaved partial sums, so results do not depend on the host either.
+using DotProductFunc = float (*)(const float* a, const float* b, u32 sampleCnt);
+
+/// @brief Returns the fastest instruction set supported by the running CPU (queried once through cpuid).
+Isa detectIsa();
+
+/// @brief Returns the kernel for the given instruction set. Falls back to the scalar kernel
+/// when the instruction set was not compiled in.
+MultiplyAddFunc getMultiplyAdd(Isa isa);
+
+/// @brief Returns the kernel for detectIsa().
+MultiplyAddFunc getMultiplyAdd();
+
+/// @brief Returns the dot product kernel for the given instruction set, or the scalar one.
+DotProductFunc getDotProduct(Isa isa);
+
+/// @brief Returns the dot product kernel for detectIsa().
+DotProductFunc getDotProduct();
+
+char const* getIsaName(Isa isa);
+
+} // namespace Simd
+} // namespace WS
@@ -15,6 +15,18 @@ public:
 
     /// @brief  New entry point which re-use the lib-streamer code.
     static int processFile(TL::LibCore::CmdLineParser& parser);
+
+    /// @brief  Writes the model folder given as "-m" option into the single-file package given as "-pack" option.
+    /// No audio is processed.
+    static int packModel(TL::LibCore::CmdLineParser& parser);
+
+    /// @brief  Reports the model throughput, in frames per second, for a range of batch sizes.
+    /// Frames are taken from the input file, no output file is written.
+    static int benchmarkModel(TL::LibCore::CmdLineParser& parser);
+
+    /// @brief  Reports the SNR of the output file against the reference file given as "-ref" option.
+    /// Only whole blocks of the shortest file are compared.
+    static int compareToReference(TL::LibCore::CmdLineParser& parser);
 };
 
 } // namespace WS
\ No newline at end of file
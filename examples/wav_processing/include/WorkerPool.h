@@ -0,0 +1,63 @@
+#pragma once
+
+#include "BasicTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WS
+{
+/// @brief Small fork-join pool for splitting the work of a single frame over several threads.
+/// The calling thread takes part in run(), so a pool of N threads starts N - 1 workers.
+/// Idle workers spin for a short while on the next run before parking on a condition variable,
+/// which keeps the wake-up latency low for back-to-back frames without burning idle cores.
+class WorkerPool
+{
+public:
+    /// @brief Runs one task: taskIdx is in [0, taskCnt), threadIdx in [0, getNumThreads()).
+    /// Two tasks never run at the same time with the same threadIdx.
+    using Task = void (*)(void* userData, u32 taskIdx, u32 threadIdx);
+
+    explicit WorkerPool(u32 const numThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// @brief Runs taskCnt tasks over the pool threads and returns once all of them are done.
+    /// Not re-entrant: a single thread may call run() at a time.
+    void run(u32 taskCnt, Task task, void* userData);
+
+    u32 getNumThreads() const;
+
+private:
+    void workerLoop(u32 threadIdx);
+    void runTasks(u32 threadIdx);
+
+    // Data members
+private:
+    u32 const mNumThreads;
+
+    /// @brief Polls before parking, 0 on single core machines
+    u32 const mSpinCnt;
+
+    /// @brief Current run, published to the workers by incrementing mGeneration
+    Task mTask{nullptr};
+    void* mUserData{nullptr};
+    u32 mTaskCnt{0};
+
+    std::atomic<u64> mGeneration{0};
+    std::atomic<u32> mNextTask{0};
+    std::atomic<u32> mBusyWorkers{0};
+    std::atomic<bool> mStop{false};
+
+    std::mutex mParkMutex;
+    std::condition_variable mWorkReady;
+    std::condition_variable mWorkDone;
+
+    std::vector<std::thread> mWorkers;
+};
+
+} // namespace WS
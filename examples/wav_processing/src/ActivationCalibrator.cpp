@@ -0,0 +1,105 @@
+#include "ActivationCalibrator.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace
+{
+using ActivationCalibrator = WS::ActivationCalibrator;
+
+/// Largest magnitude of a symmetric int8 value.
+constexpr float Int8Max{127.0F};
+
+float toScale(float absMax)
+{
+    return absMax > 0.0F ? absMax / Int8Max : 1.0F;
+}
+} // namespace
+
+std::vector<std::string> const ActivationCalibrator::DefaultLayerNames{
+    "conv_1d_abs_out", "conv_smoothing", "max_pool_out", "dense_in", "dense_local_in",
+    "dense_saaf_in", "dense_saaf_h1", "dense_saaf_h2", "dense_saaf_h3", "dense_saaf_out",
+    "cond_dense", "deconv", "dense_out"};
+
+ActivationCalibrator::ActivationCalibrator() : ActivationCalibrator{DefaultLayerNames}
+{
+}
+
+ActivationCalibrator::ActivationCalibrator(std::vector<std::string> const& layerNames)
+{
+    for(std::string const& name : layerNames)
+    {
+        LayerRange range;
+        range.name = name;
+        mLayers.push_back(range);
+    }
+}
+
+void ActivationCalibrator::collect(AudioModel& model)
+{
+    for(LayerRange& layer : mLayers)
+    {
+        size_t filterCnt{0}, sampleCnt{0};
+        float const* values{model.getValidationValues(layer.name, filterCnt, sampleCnt)};
+        if(values == nullptr || filterCnt == 0 || sampleCnt == 0)
+        {
+            continue;
+        }
+
+        if(layer.frameCnt == 0 || layer.filterCnt != filterCnt || layer.sampleCnt != sampleCnt)
+        {
+            // First frame, or the layer shape changed: restart the range.
+            layer.filterCnt = filterCnt;
+            layer.sampleCnt = sampleCnt;
+            layer.minValue = values[0];
+            layer.maxValue = values[0];
+            layer.channelAbsMax.assign(filterCnt, 0.0F);
+            layer.frameCnt = 0;
+        }
+
+        for(size_t f = 0; f < filterCnt; f++)
+        {
+            float const* channel{values + f * sampleCnt};
+            float& absMax{layer.channelAbsMax[f]};
+            for(size_t s = 0; s < sampleCnt; s++)
+            {
+                layer.minValue = std::min(layer.minValue, channel[s]);
+                layer.maxValue = std::max(layer.maxValue, channel[s]);
+                absMax = std::max(absMax, std::abs(channel[s]));
+            }
+        }
+        layer.frameCnt++;
+    }
+    mFrameCnt++;
+}
+
+void ActivationCalibrator::writeReport(std::ostream& os) const
+{
+    os << "Activation calibration over " << mFrameCnt << " frames" << std::endl;
+    for(LayerRange const& layer : mLayers)
+    {
+        if(layer.frameCnt == 0)
+        {
+            os << layer.name << ": not exposed by the model" << std::endl;
+            continue;
+        }
+
+        float const absMax{std::max(std::abs(layer.minValue), std::abs(layer.maxValue))};
+        os << layer.name << ": " << layer.filterCnt << " x " << layer.sampleCnt
+           << std::scientific << std::setprecision(6)
+           << " min " << layer.minValue << " max " << layer.maxValue
+           << " int8 scale " << toScale(absMax) << std::endl;
+
+        os << "  channel scales:";
+        for(float channelAbsMax : layer.channelAbsMax)
+        {
+            os << " " << toScale(channelAbsMax);
+        }
+        os << std::defaultfloat << std::endl;
+    }
+}
+
+u64 ActivationCalibrator::getFrameCnt() const
+{
+    return mFrameCnt;
+}
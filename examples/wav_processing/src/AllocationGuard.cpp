@@ -0,0 +1,78 @@
+#include "AllocationGuard.h"
+
+#ifndef NDEBUG
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+using AllocationGuard = WS::AllocationGuard;
+
+thread_local u64 tAllocationCnt{0};
+thread_local u32 tExcludedDepth{0};
+
+void* countedAlloc(std::size_t size)
+{
+    if(tExcludedDepth == 0)
+    {
+        tAllocationCnt++;
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    void* ptr{countedAlloc(size)};
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::nothrow_t const&) noexcept
+{
+    std::free(ptr);
+}
+
+AllocationGuard::Excluded::Excluded()
+{
+    tExcludedDepth++;
+}
+
+AllocationGuard::Excluded::~Excluded()
+{
+    tExcludedDepth--;
+}
+
+AllocationGuard::AllocationGuard() : mStartCnt{tAllocationCnt}
+{
+}
+
+AllocationGuard::~AllocationGuard()
+{
+    assert(tAllocationCnt == mStartCnt && "heap allocation inside a no-allocation scope");
+}
+
+u64 AllocationGuard::getAllocationCnt()
+{
+    return tAllocationCnt;
+}
+#endif
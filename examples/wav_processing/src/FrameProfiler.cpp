@@ -0,0 +1,138 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+using FrameProfiler = WS::FrameProfiler;
+
+constexpr double NsPerMs{1.0e6};
+
+char const* const SectionNames[]{"apply_params", "model_process", "overlap_add", "wav_read", "wav_write"};
+} // namespace
+
+FrameProfiler::Scope::Scope(FrameProfiler* profiler, Section section) : mProfiler{(profiler != nullptr && profiler->isEnabled()) ? profiler : nullptr},
+                                                                        mSection{section}
+{
+    if(mProfiler != nullptr)
+    {
+        mStart = std::chrono::steady_clock::now();
+    }
+}
+
+FrameProfiler::Scope::~Scope()
+{
+    if(mProfiler != nullptr)
+    {
+        mProfiler->record(mSection, std::chrono::steady_clock::now() - mStart);
+    }
+}
+
+FrameProfiler::FrameProfiler()
+{
+    reset();
+}
+
+void FrameProfiler::enableProfiling(bool enable)
+{
+    mEnabled = enable;
+}
+
+bool FrameProfiler::isEnabled() const
+{
+    return mEnabled;
+}
+
+void FrameProfiler::reset()
+{
+    for(SectionData& data : mSections)
+    {
+        data.callCnt = 0;
+        data.totalNs = 0;
+        data.minNs = std::numeric_limits<u64>::max();
+        data.maxNs = 0;
+        data.histogram.fill(0U);
+    }
+}
+
+void FrameProfiler::record(Section section, std::chrono::nanoseconds duration)
+{
+    u64 const ns{static_cast<u64>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0))};
+    SectionData& data{mSections[static_cast<size_t>(section)]};
+    data.callCnt++;
+    data.totalNs += ns;
+    data.minNs = std::min(data.minNs, ns);
+    data.maxNs = std::max(data.maxNs, ns);
+    data.histogram[toBucket(ns)]++;
+}
+
+std::vector<FrameProfiler::SectionStats> FrameProfiler::getStats() const
+{
+    std::vector<SectionStats> stats;
+    for(size_t s = 0; s < mSections.size(); s++)
+    {
+        SectionData const& data{mSections[s]};
+        if(data.callCnt == 0)
+        {
+            continue;
+        }
+
+        stats.push_back({SectionNames[s], data.callCnt, data.totalNs / NsPerMs, data.minNs / NsPerMs, data.maxNs / NsPerMs,
+            getPercentileMs(data, 0.50), getPercentileMs(data, 0.99)});
+    }
+    return stats;
+}
+
+char const* FrameProfiler::getSectionName(Section section)
+{
+    return section < Section::Count ? SectionNames[static_cast<size_t>(section)] : "unknown";
+}
+
+u32 FrameProfiler::toBucket(u64 ns)
+{
+    constexpr u64 subBucketCnt{1U << SubBucketBits};
+    if(ns < subBucketCnt)
+    {
+        return static_cast<u32>(ns);
+    }
+
+    // Highest bit set gives the power of two, the next SubBucketBits bits the linear sub-bucket.
+    u32 exponent{0};
+    for(u64 v = ns; v > 1; v >>= 1)
+    {
+        exponent++;
+    }
+    u32 const subBucket{static_cast<u32>((ns >> (exponent - SubBucketBits)) & (subBucketCnt - 1))};
+    return ((exponent - SubBucketBits + 1) << SubBucketBits) + subBucket;
+}
+
+u64 FrameProfiler::fromBucket(u32 bucket)
+{
+    constexpr u32 subBucketCnt{1U << SubBucketBits};
+    if(bucket < subBucketCnt)
+    {
+        return bucket;
+    }
+
+    // Middle of the bucket range.
+    u32 const exponent{(bucket >> SubBucketBits) + SubBucketBits - 1};
+    u64 const subBucket{bucket & (subBucketCnt - 1)};
+    u64 const low{(subBucketCnt + subBucket) << (exponent - SubBucketBits)};
+    return low + ((u64{1} << (exponent - SubBucketBits)) >> 1);
+}
+
+double FrameProfiler::getPercentileMs(SectionData const& data, double percentile)
+{
+    u64 const rank{static_cast<u64>(percentile * static_cast<double>(data.callCnt - 1))};
+    u64 seen{0};
+    for(u32 b = 0; b < BucketCnt; b++)
+    {
+        seen += data.histogram[b];
+        if(seen > rank)
+        {
+            // The bucket estimate is kept within the exact range seen.
+            return std::min(std::max(fromBucket(b), data.minNs), data.maxNs) / NsPerMs;
+        }
+    }
+    return data.maxNs / NsPerMs;
+}
@@ -1,4 +1,5 @@
 #include "HannFilter.h"
+#include "AllocationGuard.h"
 #include "Constants.h"
 #include <cmath>
 #include <cstring>
@@ -6,60 +7,171 @@
 namespace
 {
 using HannFilter = WS::HannFilter;
+
+/// Samples held by the parallel path: one model window per hop of a block.
+size_t getBlockBufferSize(u32 const windowSize, u32 const hopSize)
+{
+    return static_cast<size_t>(windowSize) * (hopSize > 0 ? windowSize / hopSize : 1U);
 }
+} // namespace
 
-HannFilter::HannFilter(u32 const filterWindowSize) : mWindowSize{filterWindowSize},
-                                                     mHopSize{filterWindowSize / 2}, mOverlapBuffer{new float[filterWindowSize]}, mModelInputBuffer{new float[filterWindowSize]}
+HannFilter::HannFilter(u32 const filterWindowSize) : HannFilter{filterWindowSize, filterWindowSize / 2}
 {
-    std::memset(mOverlapBuffer.get(), 0, mWindowSize);
-    std::memset(mModelInputBuffer.get(), 0, mWindowSize);
+}
+
+HannFilter::HannFilter(u32 const filterWindowSize, u32 const hopSize) : mWindowSize{filterWindowSize},
+                                                                        mHopSize{hopSize}, mOverlapGain{2.0F * hopSize / filterWindowSize},
+                                                                        mWindow{new float[filterWindowSize]}, mMultiplyAdd{Simd::getMultiplyAdd()},
+                                                                        mOverlapBuffer{new float[filterWindowSize]{}}, mModelInputBuffer{new float[filterWindowSize]{}},
+                                                                        mModelOutputBuffer{new float[filterWindowSize]{}},
+                                                                        mBlockInputs{new float[getBlockBufferSize(filterWindowSize, hopSize)]{}},
+                                                                        mBlockOutputs{new float[getBlockBufferSize(filterWindowSize, hopSize)]{}}
+{
+    for(u32 s = 0; s < mWindowSize; s++)
+    {
+        float multiplier = 0.5f * (1 - std::cos(2 * TL::LibCore::Constants::Pi<float>{}() * s / (mWindowSize - 1)));
+        mWindow[s] = multiplier * mOverlapGain;
+    }
 }
 
 bool HannFilter::applyFilter(float* dataSamples, u32 sampleCnt, AudioModel& model, float* outSamples)
 {
-    if(sampleCnt != mWindowSize)
+    if(sampleCnt != mWindowSize || mHopSize == 0 || mWindowSize % mHopSize != 0)
     {
         return false;
     }
 
-    // Process first half of data [0 - mHopSize] in dataSamples
-    if(applyFilterInternal(dataSamples, mHopSize, model, outSamples))
+    // Process the data one hop at a time: [0 - mHopSize], [mHopSize - 2 * mHopSize], ...
+    for(u32 offset = 0; offset < mWindowSize; offset += mHopSize)
     {
-        // Process second half of data [mHopSize - mWindowSize] in dataSamples
-        return applyFilterInternal(dataSamples + mHopSize, mHopSize, model, outSamples + mHopSize);
+        if(!processHop(dataSamples + offset, model, outSamples + offset))
+        {
+            return false;
+        }
     }
 
-    return false;
+    return true;
 }
 
-bool HannFilter::applyFilterInternal(float* dataSamples, u32 sampleCnt, AudioModel& model, float* outSamples)
+bool HannFilter::applyFilter(float* dataSamples, u32 sampleCnt, AudioModel* const* models, WorkerPool& pool, float* outSamples)
 {
-    if(sampleCnt != mHopSize)
+    if(sampleCnt != mWindowSize || mHopSize == 0 || mWindowSize % mHopSize != 0)
     {
         return false;
     }
 
-    // Channel 0: read old input to the first half of the model input buffer */
-    std::memcpy(mModelInputBuffer.get(), mModelInputBuffer.get() + mHopSize, mHopSize * sizeof(float));
-    std::memcpy(mModelInputBuffer.get() + mHopSize, dataSamples, mHopSize * sizeof(float));
+    AllocationGuard noAllocation;
+    u32 const hopCnt{mWindowSize / mHopSize};
+    u32 const keptSamples{mWindowSize - mHopSize};
 
-    std::unique_ptr<float> windowOut{new float[mWindowSize]{0.0}};
-    model.process(mModelInputBuffer.get(), windowOut.get());
+    for(u32 hop = 0; hop < hopCnt; hop++)
+    {
+        std::memmove(mModelInputBuffer.get(), mModelInputBuffer.get() + mHopSize, keptSamples * sizeof(float));
+        std::memcpy(mModelInputBuffer.get() + keptSamples, dataSamples + hop * mHopSize, mHopSize * sizeof(float));
+        std::memcpy(mBlockInputs.get() + hop * mWindowSize, mModelInputBuffer.get(), mWindowSize * sizeof(float));
+    }
 
-    for(u32 s = 0; s < mWindowSize; s++)
     {
-        float multiplier = 0.5f * (1 - std::cos(2 * TL::LibCore::Constants::Pi<float>{}() * s / (mWindowSize - 1)));
-        windowOut.get()[s] *= multiplier;
+        FrameProfiler::Scope timer{mProfiler, FrameProfiler::Section::ModelProcess};
+        AllocationGuard::Excluded engineCall;
+        mBlockModels = models;
+        mBlockFailed.store(false, std::memory_order_relaxed);
+        pool.run(hopCnt, &HannFilter::processWindowTask, this);
+        mBlockModels = nullptr;
     }
+    if(mBlockFailed.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    FrameProfiler::Scope timer{mProfiler, FrameProfiler::Section::OverlapAdd};
+    for(u32 hop = 0; hop < hopCnt; hop++)
+    {
+        overlapAdd(mBlockOutputs.get() + hop * mWindowSize, outSamples + hop * mHopSize);
+    }
+    return true;
+}
+
+bool HannFilter::processHop(float* dataSamples, AudioModel& model, float* outSamples)
+{
+    if(mHopSize == 0 || mWindowSize % mHopSize != 0)
+    {
+        return false;
+    }
+
+    AllocationGuard noAllocation;
+    u32 const keptSamples{mWindowSize - mHopSize};
+
+    // Channel 0: slide the model input buffer by one hop and append the new samples */
+    std::memmove(mModelInputBuffer.get(), mModelInputBuffer.get() + mHopSize, keptSamples * sizeof(float));
+    std::memcpy(mModelInputBuffer.get() + keptSamples, dataSamples, mHopSize * sizeof(float));
 
-    // Add to the first half of the overlap buffer
-    for(u32 s = 0; s < mHopSize; s++)
     {
-        mOverlapBuffer.get()[s] += windowOut.get()[s];
-        outSamples[s] = mOverlapBuffer.get()[s];
+        FrameProfiler::Scope timer{mProfiler, FrameProfiler::Section::ModelProcess};
+        AllocationGuard::Excluded engineCall;
+        if(!model.process(mModelInputBuffer.get(), mModelOutputBuffer.get()))
+        {
+            // The output buffer still holds the previous hop: nothing is overlap-added
+            return false;
+        }
     }
 
-    // Copy to overlap buffer for next hop
-    std::memcpy(mOverlapBuffer.get(), static_cast<void*>(&windowOut.get()[mHopSize]), mHopSize * sizeof(float));
+    if(mModelCallback != nullptr)
+    {
+        AllocationGuard::Excluded callback;
+        mModelCallback(mModelCallbackData, model);
+    }
+
+    FrameProfiler::Scope timer{mProfiler, FrameProfiler::Section::OverlapAdd};
+    overlapAdd(mModelOutputBuffer.get(), outSamples);
     return true;
 }
+
+void HannFilter::overlapAdd(const float* modelOutput, float* outSamples)
+{
+    u32 const keptSamples{mWindowSize - mHopSize};
+
+    // Window and add to the overlap buffer, the first hop is now complete
+    mMultiplyAdd(mOverlapBuffer.get(), modelOutput, mWindow.get(), mWindowSize);
+    std::memcpy(outSamples, mOverlapBuffer.get(), mHopSize * sizeof(float));
+
+    // Slide the overlap buffer for next hop
+    std::memmove(mOverlapBuffer.get(), mOverlapBuffer.get() + mHopSize, keptSamples * sizeof(float));
+    std::memset(mOverlapBuffer.get() + keptSamples, 0, mHopSize * sizeof(float));
+}
+
+void HannFilter::processWindowTask(void* userData, u32 hop, u32 threadIdx)
+{
+    HannFilter& filter{*static_cast<HannFilter*>(userData)};
+    size_t const offset{static_cast<size_t>(hop) * filter.mWindowSize};
+    if(!filter.mBlockModels[threadIdx]->process(filter.mBlockInputs.get() + offset, filter.mBlockOutputs.get() + offset))
+    {
+        filter.mBlockFailed.store(true, std::memory_order_relaxed);
+    }
+}
+
+void HannFilter::setProfiler(FrameProfiler* profiler)
+{
+    mProfiler = profiler;
+}
+
+void HannFilter::setModelCallback(ModelCallback callback, void* userData)
+{
+    mModelCallback = callback;
+    mModelCallbackData = userData;
+}
+
+bool HannFilter::hasModelCallback() const
+{
+    return mModelCallback != nullptr;
+}
+
+u32 HannFilter::getWindowSize() const
+{
+    return mWindowSize;
+}
+
+u32 HannFilter::getHopSize() const
+{
+    return mHopSize;
+}
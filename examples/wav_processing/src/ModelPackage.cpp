@@ -0,0 +1,225 @@
+#include "ModelPackage.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+using ModelPackage = WS::ModelPackage;
+namespace fs = std::filesystem;
+
+constexpr char PackageMagic[4]{'W', 'S', 'M', 'P'};
+constexpr size_t SectionNameSize{40U};
+
+/// Makes the names of the folders extracted by this process unique.
+std::atomic<u32> ExtractedFolderCnt{0};
+
+struct FileHeader
+{
+    char magic[4];
+    u32 version;
+    u32 sectionCnt;
+    u32 headerSize;
+    u8 reserved[48];
+};
+
+struct SectionEntry
+{
+    char name[SectionNameSize];
+    u64 offset;
+    u64 size;
+    u64 reserved;
+};
+
+static_assert(sizeof(FileHeader) == ModelPackage::Alignment, "the file header must fill one aligned block");
+static_assert(sizeof(SectionEntry) == ModelPackage::Alignment, "a section entry must fill one aligned block");
+
+u64 alignUp(u64 value)
+{
+    return (value + ModelPackage::Alignment - 1) / ModelPackage::Alignment * ModelPackage::Alignment;
+}
+
+bool readFileHeader(std::ifstream& ifs, FileHeader& header)
+{
+    if(!ifs.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return false;
+    }
+    return std::memcmp(header.magic, PackageMagic, sizeof(PackageMagic)) == 0 && header.version == ModelPackage::FormatVersion &&
+           header.headerSize == sizeof(FileHeader);
+}
+
+/// Section names become file names in the extracted folder: only plain names are accepted.
+bool isValidSectionName(std::string const& name)
+{
+    return !name.empty() && name.size() < SectionNameSize && name != "." && name != ".." &&
+           name.find_first_of("/\\:") == std::string::npos;
+}
+} // namespace
+
+ModelPackage::~ModelPackage()
+{
+    removeFolder();
+}
+
+bool ModelPackage::isPackage(std::string const& path)
+{
+    std::error_code error;
+    if(!fs::is_regular_file(path, error))
+    {
+        return false;
+    }
+
+    std::ifstream ifs{path, std::ios_base::in | std::ios_base::binary};
+    FileHeader header;
+    return ifs.is_open() && readFileHeader(ifs, header);
+}
+
+bool ModelPackage::pack(std::string const& modelFolder, std::string const& packagePath)
+{
+    std::error_code error;
+    std::vector<fs::path> files;
+    for(fs::directory_iterator it{modelFolder, error}, end; !error && it != end; it.increment(error))
+    {
+        if(it->is_regular_file(error) && isValidSectionName(it->path().filename().string()))
+        {
+            files.push_back(it->path());
+        }
+    }
+    if(error || files.empty())
+    {
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    FileHeader header{};
+    std::memcpy(header.magic, PackageMagic, sizeof(PackageMagic));
+    header.version = FormatVersion;
+    header.sectionCnt = static_cast<u32>(files.size());
+    header.headerSize = sizeof(FileHeader);
+
+    std::vector<SectionEntry> entries(files.size());
+    u64 offset{sizeof(FileHeader) + entries.size() * sizeof(SectionEntry)};
+    for(size_t s = 0; s < files.size(); s++)
+    {
+        std::string const name{files[s].filename().string()};
+        std::memcpy(entries[s].name, name.c_str(), name.size());
+        entries[s].size = fs::file_size(files[s], error);
+        if(error)
+        {
+            return false;
+        }
+        entries[s].offset = alignUp(offset);
+        offset = entries[s].offset + entries[s].size;
+    }
+
+    std::ofstream ofs{packagePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc};
+    ofs.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<char const*>(entries.data()), entries.size() * sizeof(SectionEntry));
+
+    std::vector<char> data;
+    char const padding[Alignment]{};
+    for(size_t s = 0; s < files.size() && ofs; s++)
+    {
+        u64 const position{static_cast<u64>(ofs.tellp())};
+        ofs.write(padding, static_cast<std::streamsize>(entries[s].offset - position));
+
+        std::ifstream ifs{files[s], std::ios_base::in | std::ios_base::binary};
+        data.resize(entries[s].size);
+        if(!ifs.read(data.data(), static_cast<std::streamsize>(data.size())))
+        {
+            return false;
+        }
+        ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    return static_cast<bool>(ofs);
+}
+
+bool ModelPackage::extract(std::string const& packagePath)
+{
+    removeFolder();
+
+    std::error_code error;
+    u64 const fileSize{fs::file_size(packagePath, error)};
+    std::ifstream ifs{packagePath, std::ios_base::in | std::ios_base::binary};
+    FileHeader header;
+    if(error || !ifs.is_open() || !readFileHeader(ifs, header))
+    {
+        return false;
+    }
+
+    // Every size below comes from the file: nothing is allocated before it is checked against the file size.
+    u64 const tableEnd{sizeof(FileHeader) + static_cast<u64>(header.sectionCnt) * sizeof(SectionEntry)};
+    if(tableEnd > fileSize)
+    {
+        return false;
+    }
+    std::vector<SectionEntry> entries(header.sectionCnt);
+    if(!ifs.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(SectionEntry))))
+    {
+        return false;
+    }
+
+    // The whole file is read at once, sections are then written out of memory.
+    u64 packageSize{0};
+    for(SectionEntry const& entry : entries)
+    {
+        if(entry.offset < tableEnd || entry.offset > fileSize || entry.size > fileSize - entry.offset)
+        {
+            return false;
+        }
+        packageSize = std::max(packageSize, entry.offset + entry.size);
+    }
+    std::vector<char> data(packageSize);
+    ifs.seekg(0);
+    if(!ifs.read(data.data(), static_cast<std::streamsize>(data.size())))
+    {
+        return false;
+    }
+
+    fs::path folder{fs::temp_directory_path(error)};
+    folder /= "wsmodel-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-" +
+              std::to_string(ExtractedFolderCnt++);
+    if(error || !fs::create_directory(folder, error))
+    {
+        return false;
+    }
+    mFolder = folder.string();
+
+    for(SectionEntry const& entry : entries)
+    {
+        std::string const name{entry.name, std::find(entry.name, entry.name + SectionNameSize, '\0')};
+        if(!isValidSectionName(name) || entry.offset % Alignment != 0)
+        {
+            removeFolder();
+            return false;
+        }
+
+        std::ofstream ofs{folder / name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc};
+        if(!ofs.write(data.data() + entry.offset, static_cast<std::streamsize>(entry.size)))
+        {
+            removeFolder();
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string const& ModelPackage::getFolder() const
+{
+    return mFolder;
+}
+
+void ModelPackage::removeFolder()
+{
+    if(!mFolder.empty())
+    {
+        std::error_code error;
+        fs::remove_all(mFolder, error);
+        mFolder.clear();
+    }
+}
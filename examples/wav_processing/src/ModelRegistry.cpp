@@ -0,0 +1,222 @@
+#include "ModelRegistry.h"
+#include "ModelPackage.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+using ModelRegistry = WS::ModelRegistry;
+namespace fs = std::filesystem;
+
+constexpr u64 FnvOffsetBasis{14695981039346656037ULL};
+constexpr u64 FnvPrime{1099511628211ULL};
+
+void hashBytes(u64& hash, char const* data, size_t size)
+{
+    for(size_t b = 0; b < size; b++)
+    {
+        hash = (hash ^ static_cast<u8>(data[b])) * FnvPrime;
+    }
+}
+
+/// FNV-1a of the file name and content, chained into hash.
+bool hashFile(u64& hash, fs::path const& file)
+{
+    std::ifstream ifs{file, std::ios_base::in | std::ios_base::binary};
+    if(!ifs.is_open())
+    {
+        return false;
+    }
+
+    std::string const name{file.filename().string()};
+    hashBytes(hash, name.c_str(), name.size() + 1);
+
+    char buffer[4096];
+    while(ifs.read(buffer, sizeof(buffer)) || ifs.gcount() > 0)
+    {
+        hashBytes(hash, buffer, static_cast<size_t>(ifs.gcount()));
+    }
+    return true;
+}
+} // namespace
+
+ModelRegistry& ModelRegistry::getInstance()
+{
+    static ModelRegistry registry;
+    return registry;
+}
+
+std::unique_ptr<WS::AudioModel> ModelRegistry::prepareModel(std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    std::unique_ptr<AudioModel> audioModel{new AudioModel(activation, sampleRate)};
+    if(!audioModel)
+    {
+        return nullptr;
+    }
+
+    // A packed model is extracted next to the other temporary files, then loaded as a folder.
+    std::string modelName{modelPath};
+    ModelPackage package;
+    if(ModelPackage::isPackage(modelName))
+    {
+        if(!package.extract(modelName))
+        {
+            return nullptr;
+        }
+        modelName = package.getFolder();
+    }
+#ifdef OS_WINDOWS
+    modelName += "\\";
+#else
+    modelName += "/";
+#endif
+    if(!audioModel->prepare(modelName))
+    {
+        return nullptr;
+    }
+    return audioModel;
+}
+
+std::shared_ptr<WS::SharedModel> ModelRegistry::acquire(std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    std::string const key{getKey(modelPath, activation, sampleRate)};
+    if(key.empty())
+    {
+        return nullptr;
+    }
+    return acquireLocked(key, modelPath, activation, sampleRate);
+}
+
+bool ModelRegistry::pin(std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    std::string const key{getKey(modelPath, activation, sampleRate)};
+    if(key.empty())
+    {
+        return false;
+    }
+
+    std::shared_ptr<SharedModel> model{acquireLocked(key, modelPath, activation, sampleRate)};
+    if(!model)
+    {
+        return false;
+    }
+    mEntries[key].pinned = model;
+    return true;
+}
+
+void ModelRegistry::unpin(std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    std::shared_ptr<SharedModel> released;
+
+    std::lock_guard<std::mutex> lock{mMutex};
+    std::string const key{getKey(modelPath, activation, sampleRate)};
+    auto const found{mEntries.find(key)};
+    if(found != mEntries.end())
+    {
+        // Freed once the lock is released, if this was the last reference
+        released = std::move(found->second.pinned);
+    }
+    removeReleased();
+}
+
+size_t ModelRegistry::getModelCnt()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    removeReleased();
+    return mEntries.size();
+}
+
+std::string ModelRegistry::getKey(std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    std::error_code error;
+    std::vector<fs::path> files;
+    if(fs::is_directory(modelPath, error))
+    {
+        for(fs::directory_iterator it{modelPath, error}, end; !error && it != end; it.increment(error))
+        {
+            if(it->is_regular_file(error))
+            {
+                files.push_back(it->path());
+            }
+        }
+    }
+    else if(fs::is_regular_file(modelPath, error))
+    {
+        files.push_back(modelPath);
+    }
+    if(error || files.empty())
+    {
+        return {};
+    }
+    std::sort(files.begin(), files.end());
+
+    fs::path const canonicalPath{fs::weakly_canonical(modelPath, error)};
+    std::string const path{error ? modelPath : canonicalPath.string()};
+
+    std::string fileStamps;
+    for(fs::path const& file : files)
+    {
+        u64 const size{fs::file_size(file, error)};
+        auto const writeTime{fs::last_write_time(file, error).time_since_epoch().count()};
+        fileStamps += file.filename().string() + ":" + std::to_string(size) + ":" + std::to_string(writeTime) + ";";
+    }
+
+    FileHash& fileHash{mFileHashes[path]};
+    if(fileHash.fileStamps != fileStamps)
+    {
+        u64 hash{FnvOffsetBasis};
+        for(fs::path const& file : files)
+        {
+            if(!hashFile(hash, file))
+            {
+                mFileHashes.erase(path);
+                return {};
+            }
+        }
+        fileHash.fileStamps = fileStamps;
+        fileHash.hash = hash;
+    }
+
+    return path + "|" + activation + "|" + std::to_string(sampleRate) + "|" + std::to_string(fileHash.hash);
+}
+
+std::shared_ptr<WS::SharedModel> ModelRegistry::acquireLocked(std::string const& key, std::string const& modelPath, std::string const& activation, u32 sampleRate)
+{
+    removeReleased();
+    Entry& entry{mEntries[key]};
+    std::shared_ptr<SharedModel> model{entry.model.lock()};
+    if(model)
+    {
+        return model;
+    }
+
+    std::unique_ptr<AudioModel> audioModel{prepareModel(modelPath, activation, sampleRate)};
+    if(!audioModel)
+    {
+        mEntries.erase(key);
+        return nullptr;
+    }
+
+    model = std::make_shared<SharedModel>(std::move(audioModel));
+    entry.model = model;
+    return model;
+}
+
+void ModelRegistry::removeReleased()
+{
+    for(auto it = mEntries.begin(); it != mEntries.end();)
+    {
+        if(it->second.model.expired())
+        {
+            it = mEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
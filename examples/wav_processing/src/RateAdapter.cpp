@@ -0,0 +1,72 @@
+#include "RateAdapter.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+using RateAdapter = WS::RateAdapter;
+
+/// Silence the output starts with: the stream samples one processed block turns back into, plus rounding margin.
+u32 getLeadingSilence(u32 const streamRate, u32 const processRate, u32 const blockSize)
+{
+    return static_cast<u32>((static_cast<u64>(blockSize) * streamRate + processRate - 1) / processRate) + 4U;
+}
+} // namespace
+
+RateAdapter::RateAdapter(u32 const streamRate, u32 const processRate, u32 const blockSize, u32 const processDelay, BlockFunc blockFunc) : mBlockSize{blockSize},
+                                                                                                                                    mBlockFunc{std::move(blockFunc)},
+                                                                                                                                    mInputResampler{streamRate, processRate, blockSize},
+                                                                                                                                    mOutputResampler{processRate, streamRate, blockSize},
+                                                                                                                                    mProcessInput{new float[blockSize + mInputResampler.getMaxOutputCnt()]{}},
+                                                                                                                                    mProcessOutput{new float[blockSize]{}},
+                                                                                                                                    mStreamOutputCapacity{2 * getLeadingSilence(streamRate, processRate, blockSize) + blockSize + mOutputResampler.getMaxOutputCnt()},
+                                                                                                                                    mStreamOutput{new float[mStreamOutputCapacity]{}}
+{
+    u32 const leadingSilence{getLeadingSilence(streamRate, processRate, blockSize)};
+    mStreamOutputCnt = leadingSilence;
+
+    double const rateRatio{static_cast<double>(streamRate) / processRate};
+    double const delay{leadingSilence + mInputResampler.getDelay() + (processDelay + mOutputResampler.getDelay()) * rateRatio};
+    mLatencySamples = static_cast<u32>(std::lround(delay));
+}
+
+bool RateAdapter::process(const float* dataSamples, float* outSamples)
+{
+    u32 resampledCnt{0};
+    if(!mInputResampler.process(dataSamples, mBlockSize, mProcessInput.get() + mProcessInputCnt, resampledCnt))
+    {
+        return false;
+    }
+    mProcessInputCnt += resampledCnt;
+
+    while(mProcessInputCnt >= mBlockSize)
+    {
+        if(!mBlockFunc(mProcessInput.get(), mProcessOutput.get()))
+        {
+            return false;
+        }
+        mProcessInputCnt -= mBlockSize;
+        std::memmove(mProcessInput.get(), mProcessInput.get() + mBlockSize, mProcessInputCnt * sizeof(float));
+
+        if(mStreamOutputCnt + mOutputResampler.getMaxOutputCnt() > mStreamOutputCapacity ||
+           !mOutputResampler.process(mProcessOutput.get(), mBlockSize, mStreamOutput.get() + mStreamOutputCnt, resampledCnt))
+        {
+            return false;
+        }
+        mStreamOutputCnt += resampledCnt;
+    }
+
+    if(mStreamOutputCnt < mBlockSize)
+    {
+        return false;
+    }
+    std::memcpy(outSamples, mStreamOutput.get(), mBlockSize * sizeof(float));
+    mStreamOutputCnt -= mBlockSize;
+    std::memmove(mStreamOutput.get(), mStreamOutput.get() + mBlockSize, mStreamOutputCnt * sizeof(float));
+    return true;
+}
+
+u32 RateAdapter::getLatencySamples() const
+{
+    return mLatencySamples;
+}
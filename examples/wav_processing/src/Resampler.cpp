@@ -0,0 +1,99 @@
+#include "Resampler.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+using Resampler = WS::Resampler;
+
+/// Zero crossings of the sinc kept on each side of its center, at the lower of the two rates.
+constexpr u32 ZeroCrossings{12U};
+/// Cutoff, as a fraction of the Nyquist frequency of the lower rate.
+constexpr double Rolloff{0.92};
+/// Kaiser window shape: about 80 dB of stopband attenuation.
+constexpr double KaiserBeta{8.0};
+
+/// Modified Bessel function of the first kind, order 0.
+double besselI0(double x)
+{
+    double sum{1.0};
+    double term{1.0};
+    for(u32 k = 1; k < 50; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if(term < sum * 1.0e-12)
+            break;
+    }
+    return sum;
+}
+
+u32 getTapCnt(u32 const upFactor, u32 const downFactor)
+{
+    double const span{2.0 * ZeroCrossings * std::max(upFactor, downFactor) / Rolloff};
+    return static_cast<u32>(std::ceil(span / upFactor));
+}
+} // namespace
+
+Resampler::Resampler(u32 const inRate, u32 const outRate, u32 const maxInputCnt) : mUpFactor{outRate / std::gcd(inRate, outRate)},
+                                                                                 mDownFactor{inRate / std::gcd(inRate, outRate)}, mMaxInputCnt{maxInputCnt},
+                                                                                 mTapCnt{getTapCnt(mUpFactor, mDownFactor)},
+                                                                                 mCoeffs{new float[static_cast<size_t>(mUpFactor) * mTapCnt]},
+                                                                                 mInput{new float[mTapCnt - 1 + maxInputCnt]{}}, mDotProduct{Simd::getDotProduct()}
+{
+    // Prototype low-pass at the upsampled rate, scaled by the up factor to keep the passband gain at 1.
+    double const pi{TL::LibCore::Constants::Pi<double>{}()};
+    double const cutoff{0.5 * Rolloff / std::max(mUpFactor, mDownFactor)};
+    u32 const length{mUpFactor * mTapCnt};
+    double const center{(length - 1) / 2.0};
+    for(u32 i = 0; i < length; i++)
+    {
+        double const x{i - center};
+        double const sinc{x == 0.0 ? 1.0 : std::sin(2.0 * pi * cutoff * x) / (2.0 * pi * cutoff * x)};
+        double const ratio{x / (center + 1.0)};
+        double const window{besselI0(KaiserBeta * std::sqrt(1.0 - ratio * ratio)) / besselI0(KaiserBeta)};
+
+        // Tap j of phase p is prototype sample p + j * L, stored reversed
+        u32 const phase{i % mUpFactor};
+        u32 const tap{i / mUpFactor};
+        mCoeffs[static_cast<size_t>(phase) * mTapCnt + (mTapCnt - 1 - tap)] = static_cast<float>(2.0 * cutoff * sinc * window * mUpFactor);
+    }
+}
+
+bool Resampler::process(const float* in, u32 inCnt, float* out, u32& outCnt)
+{
+    outCnt = 0;
+    if(inCnt > mMaxInputCnt)
+    {
+        return false;
+    }
+
+    u32 const historyCnt{mTapCnt - 1};
+    std::memcpy(mInput.get() + historyCnt, in, inCnt * sizeof(float));
+
+    // Output sample at input position n ends its window on mInput[historyCnt + n]
+    while(mInputPos < inCnt)
+    {
+        out[outCnt++] = mDotProduct(mCoeffs.get() + static_cast<size_t>(mPhase) * mTapCnt, mInput.get() + mInputPos, mTapCnt);
+        mPhase += mDownFactor;
+        mInputPos += mPhase / mUpFactor;
+        mPhase %= mUpFactor;
+    }
+    mInputPos -= inCnt;
+
+    std::memmove(mInput.get(), mInput.get() + inCnt, historyCnt * sizeof(float));
+    return true;
+}
+
+u32 Resampler::getMaxOutputCnt() const
+{
+    return static_cast<u32>((static_cast<u64>(mMaxInputCnt) * mUpFactor + mDownFactor - 1) / mDownFactor) + 1;
+}
+
+double Resampler::getDelay() const
+{
+    return (static_cast<double>(mUpFactor) * mTapCnt - 1.0) / (2.0 * mUpFactor);
+}
@@ -0,0 +1,235 @@
+#include "SharedModel.h"
+#include "AllocationGuard.h"
+#include <algorithm>
+
+namespace
+{
+using SharedModel = WS::SharedModel;
+using StreamContext = WS::StreamContext;
+} // namespace
+
+StreamContext::StreamContext(u32 const frameLength, std::vector<float> const& paramValues) : mFrameLength{frameLength},
+                                                                                             mHannFilter{frameLength}, mPublishedParamValues{new std::atomic<float>[paramValues.size()]},
+                                                                                             mParamValues{paramValues}, mTargetParamValues{paramValues}, mHopParamValues{paramValues}
+{
+    for(size_t p = 0; p < paramValues.size(); p++)
+    {
+        mPublishedParamValues[p].store(paramValues[p], std::memory_order_relaxed);
+    }
+}
+
+void StreamContext::setParamValueAt(ParamId param, float value)
+{
+    if(param < mParamValues.size())
+    {
+        mPublishedParamValues[param].store(value, std::memory_order_relaxed);
+    }
+}
+
+std::vector<float> const& StreamContext::getParamValues() const
+{
+    return mParamValues;
+}
+
+bool StreamContext::loadTargetParamValues()
+{
+    bool changed{false};
+    for(size_t p = 0; p < mTargetParamValues.size(); p++)
+    {
+        mTargetParamValues[p] = mPublishedParamValues[p].load(std::memory_order_relaxed);
+        changed |= mTargetParamValues[p] != mParamValues[p];
+    }
+    return changed;
+}
+
+void StreamContext::setModelCallback(HannFilter::ModelCallback callback, void* userData)
+{
+    mHannFilter.setModelCallback(callback, userData);
+}
+
+u32 StreamContext::getFrameLength() const
+{
+    return mFrameLength;
+}
+
+SharedModel::SharedModel(std::unique_ptr<AudioModel> model) : mModel{std::move(model)},
+                                                              mFrameLength{mModel->getFrameLength()}, mDefaultParamValues(mModel->getNumberOfParams(), 0.0F),
+                                                              mAppliedParamValues(mDefaultParamValues.size(), 0.0F),
+                                                              mThreadModels{mModel.get()}
+{
+}
+
+void SharedModel::setParamValueAt(ParamId param, float value)
+{
+    std::lock_guard<std::mutex> lock{mModelMutex};
+    if(param < mDefaultParamValues.size())
+    {
+        mDefaultParamValues[param] = value;
+    }
+}
+
+bool SharedModel::loadJsonEQParameters(std::string const& inJsonConfigPathName, int samplingRate)
+{
+    std::lock_guard<std::mutex> lock{mModelMutex};
+    for(AudioModel* model : mThreadModels)
+    {
+        if(!model->loadJsonEQParameters(inJsonConfigPathName, samplingRate))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<StreamContext> SharedModel::createContext()
+{
+    std::unique_ptr<StreamContext> context{new StreamContext{static_cast<u32>(mFrameLength), mDefaultParamValues}};
+    context->mHannFilter.setProfiler(&mProfiler);
+    return context;
+}
+
+bool SharedModel::process(StreamContext& context, float* dataSamples, float* outSamples)
+{
+    if(context.mFrameLength != mFrameLength)
+    {
+        return false;
+    }
+
+    AllocationGuard noAllocation;
+    std::lock_guard<std::mutex> lock{mModelMutex};
+    if(context.loadTargetParamValues())
+    {
+        return processRamp(context, dataSamples, outSamples);
+    }
+
+    applyParamValues(context.mParamValues);
+    if(mWorkerPool && !context.mHannFilter.hasModelCallback())
+    {
+        return context.mHannFilter.applyFilter(dataSamples, context.mFrameLength, mThreadModels.data(), *mWorkerPool, outSamples);
+    }
+    return context.mHannFilter.applyFilter(dataSamples, context.mFrameLength, *mModel, outSamples);
+}
+
+bool SharedModel::processRamp(StreamContext& context, float* dataSamples, float* outSamples)
+{
+    HannFilter& hannFilter{context.mHannFilter};
+    u32 const hopSize{hannFilter.getHopSize()};
+    if(hopSize == 0 || context.mFrameLength % hopSize != 0)
+    {
+        return false;
+    }
+
+    // Hops run in order on the first model, each one a step closer to the published values:
+    // the overlap-add then crossfades between the steps.
+    u32 const hopCnt{context.mFrameLength / hopSize};
+    for(u32 hop = 0; hop < hopCnt; hop++)
+    {
+        float const ratio{static_cast<float>(hop + 1) / static_cast<float>(hopCnt)};
+        for(size_t p = 0; p < context.mHopParamValues.size(); p++)
+        {
+            float const from{context.mParamValues[p]};
+            context.mHopParamValues[p] = from + (context.mTargetParamValues[p] - from) * ratio;
+        }
+        applyParamValues(context.mHopParamValues);
+
+        if(!hannFilter.processHop(dataSamples + hop * hopSize, *mModel, outSamples + hop * hopSize))
+        {
+            return false;
+        }
+    }
+
+    std::copy(context.mTargetParamValues.begin(), context.mTargetParamValues.end(), context.mParamValues.begin());
+    return true;
+}
+
+void SharedModel::applyParamValues(std::vector<float> const& paramValues)
+{
+    FrameProfiler::Scope timer{&mProfiler, FrameProfiler::Section::ApplyParams};
+    AllocationGuard::Excluded engineCall;
+    for(size_t p = 0; p < paramValues.size() && p < mAppliedParamValues.size(); p++)
+    {
+        float const value{paramValues[p]};
+
+        // A static parameter leaves the model conditioning untouched
+        if(mAppliedParamsValid && value == mAppliedParamValues[p])
+        {
+            continue;
+        }
+
+        for(AudioModel* model : mThreadModels)
+        {
+            model->setParamValueAt(p, value);
+        }
+        mAppliedParamValues[p] = value;
+    }
+    mAppliedParamsValid = true;
+}
+
+bool SharedModel::setNumThreads(u32 numThreads, ModelFactory const& factory)
+{
+    if(numThreads == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{mModelMutex};
+    std::vector<std::unique_ptr<AudioModel>> replicas;
+    for(u32 t = 1; t < numThreads; t++)
+    {
+        if(t <= mReplicas.size())
+        {
+            replicas.push_back(std::move(mReplicas[t - 1]));
+            continue;
+        }
+
+        std::unique_ptr<AudioModel> replica{factory ? factory() : nullptr};
+        if(!replica || replica->getFrameLength() != mFrameLength)
+        {
+            // Hand the moved replicas back before giving up, the newly created ones are dropped
+            for(size_t r = 0; r < replicas.size() && r < mReplicas.size(); r++)
+            {
+                mReplicas[r] = std::move(replicas[r]);
+            }
+            return false;
+        }
+        replicas.push_back(std::move(replica));
+    }
+
+    mReplicas = std::move(replicas);
+    mThreadModels.assign(1, mModel.get());
+    for(std::unique_ptr<AudioModel> const& replica : mReplicas)
+    {
+        mThreadModels.push_back(replica.get());
+    }
+    mWorkerPool.reset(numThreads > 1 ? new WorkerPool{numThreads} : nullptr);
+
+    // New replicas come with their own parameter values
+    mAppliedParamsValid = false;
+    return true;
+}
+
+u32 SharedModel::getNumThreads() const
+{
+    return static_cast<u32>(mThreadModels.size());
+}
+
+void SharedModel::enableProfiling(bool enable)
+{
+    std::lock_guard<std::mutex> lock{mModelMutex};
+    mProfiler.enableProfiling(enable);
+}
+
+WS::FrameProfiler& SharedModel::getProfiler()
+{
+    return mProfiler;
+}
+
+size_t SharedModel::getFrameLength() const
+{
+    return mFrameLength;
+}
+
+size_t SharedModel::getNumberOfParams() const
+{
+    return mDefaultParamValues.size();
+}
@@ -0,0 +1,222 @@
+#include "SimdKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WS_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Contraction is turned off for the whole file, scalar kernels and tails included, so that the compiler never
+// fuses a separate multiply and add into an FMA: every kernel then rounds like the scalar one, whatever -march is.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+#if defined(__GNUC__)
+#define WS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define WS_TARGET(isa)
+#endif
+
+namespace
+{
+using Isa = WS::Simd::Isa;
+
+/// Partial sums of the dot product kernels: one AVX-512 register, two AVX2 ones.
+constexpr u32 DotLaneCnt{16U};
+
+void multiplyAddScalar(float* acc, const float* samples, const float* window, u32 sampleCnt)
+{
+    for(u32 s = 0; s < sampleCnt; s++)
+    {
+        acc[s] += samples[s] * window[s];
+    }
+}
+
+/// Adds the last sampleCnt < DotLaneCnt products to the partial sums, then reduces them in a fixed order.
+float finishDotProduct(float* lanes, const float* a, const float* b, u32 sampleCnt)
+{
+    for(u32 s = 0; s < sampleCnt; s++)
+    {
+        lanes[s] += a[s] * b[s];
+    }
+    for(u32 width = DotLaneCnt / 2; width > 0; width /= 2)
+    {
+        for(u32 l = 0; l < width; l++)
+        {
+            lanes[l] += lanes[l + width];
+        }
+    }
+    return lanes[0];
+}
+
+float dotProductScalar(const float* a, const float* b, u32 sampleCnt)
+{
+    float lanes[DotLaneCnt]{};
+    u32 s = 0;
+    for(; s + DotLaneCnt <= sampleCnt; s += DotLaneCnt)
+    {
+        for(u32 l = 0; l < DotLaneCnt; l++)
+        {
+            lanes[l] += a[s + l] * b[s + l];
+        }
+    }
+    return finishDotProduct(lanes, a + s, b + s, sampleCnt - s);
+}
+
+#ifdef WS_SIMD_X86
+// Multiply and add are kept as two instructions (no FMA) to round like multiplyAddScalar().
+WS_TARGET("avx2")
+void multiplyAddAvx2(float* acc, const float* samples, const float* window, u32 sampleCnt)
+{
+    u32 s = 0;
+    for(; s + 8 <= sampleCnt; s += 8)
+    {
+        __m256 product = _mm256_mul_ps(_mm256_loadu_ps(samples + s), _mm256_loadu_ps(window + s));
+        _mm256_storeu_ps(acc + s, _mm256_add_ps(_mm256_loadu_ps(acc + s), product));
+    }
+    multiplyAddScalar(acc + s, samples + s, window + s, sampleCnt - s);
+}
+
+WS_TARGET("avx512f")
+void multiplyAddAvx512(float* acc, const float* samples, const float* window, u32 sampleCnt)
+{
+    u32 s = 0;
+    for(; s + 16 <= sampleCnt; s += 16)
+    {
+        __m512 product = _mm512_mul_ps(_mm512_loadu_ps(samples + s), _mm512_loadu_ps(window + s));
+        _mm512_storeu_ps(acc + s, _mm512_add_ps(_mm512_loadu_ps(acc + s), product));
+    }
+    multiplyAddScalar(acc + s, samples + s, window + s, sampleCnt - s);
+}
+
+WS_TARGET("avx2")
+float dotProductAvx2(const float* a, const float* b, u32 sampleCnt)
+{
+    __m256 sumLow = _mm256_setzero_ps();
+    __m256 sumHigh = _mm256_setzero_ps();
+    u32 s = 0;
+    for(; s + DotLaneCnt <= sampleCnt; s += DotLaneCnt)
+    {
+        sumLow = _mm256_add_ps(sumLow, _mm256_mul_ps(_mm256_loadu_ps(a + s), _mm256_loadu_ps(b + s)));
+        sumHigh = _mm256_add_ps(sumHigh, _mm256_mul_ps(_mm256_loadu_ps(a + s + 8), _mm256_loadu_ps(b + s + 8)));
+    }
+    float lanes[DotLaneCnt];
+    _mm256_storeu_ps(lanes, sumLow);
+    _mm256_storeu_ps(lanes + 8, sumHigh);
+    return finishDotProduct(lanes, a + s, b + s, sampleCnt - s);
+}
+
+WS_TARGET("avx512f")
+float dotProductAvx512(const float* a, const float* b, u32 sampleCnt)
+{
+    __m512 sum = _mm512_setzero_ps();
+    u32 s = 0;
+    for(; s + DotLaneCnt <= sampleCnt; s += DotLaneCnt)
+    {
+        sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_loadu_ps(a + s), _mm512_loadu_ps(b + s)));
+    }
+    float lanes[DotLaneCnt];
+    _mm512_storeu_ps(lanes, sum);
+    return finishDotProduct(lanes, a + s, b + s, sampleCnt - s);
+}
+
+Isa queryIsa()
+{
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return Isa::Avx512;
+    if(__builtin_cpu_supports("avx2"))
+        return Isa::Avx2;
+#elif defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    bool const osXSave{(regs[2] & (1 << 27)) != 0};
+    if(osXSave)
+    {
+        unsigned long long const xcr0{_xgetbv(0)};
+        __cpuidex(regs, 7, 0);
+        // XMM, YMM and the three AVX-512 state components must be enabled by the OS.
+        if((regs[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6)
+            return Isa::Avx512;
+        if((regs[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6)
+            return Isa::Avx2;
+    }
+#endif
+    return Isa::Scalar;
+}
+#else
+Isa queryIsa()
+{
+    return Isa::Scalar;
+}
+#endif
+} // namespace
+
+WS::Simd::Isa WS::Simd::detectIsa()
+{
+    static Isa const isa{queryIsa()};
+    return isa;
+}
+
+WS::Simd::MultiplyAddFunc WS::Simd::getMultiplyAdd(Isa isa)
+{
+#ifdef WS_SIMD_X86
+    switch(isa)
+    {
+    case Isa::Avx512:
+        return multiplyAddAvx512;
+    case Isa::Avx2:
+        return multiplyAddAvx2;
+    default:
+        break;
+    }
+#endif
+    return multiplyAddScalar;
+}
+
+WS::Simd::MultiplyAddFunc WS::Simd::getMultiplyAdd()
+{
+    return getMultiplyAdd(detectIsa());
+}
+
+WS::Simd::DotProductFunc WS::Simd::getDotProduct(Isa isa)
+{
+#ifdef WS_SIMD_X86
+    switch(isa)
+    {
+    case Isa::Avx512:
+        return dotProductAvx512;
+    case Isa::Avx2:
+        return dotProductAvx2;
+    default:
+        break;
+    }
+#endif
+    return dotProductScalar;
+}
+
+WS::Simd::DotProductFunc WS::Simd::getDotProduct()
+{
+    return getDotProduct(detectIsa());
+}
+
+char const* WS::Simd::getIsaName(Isa isa)
+{
+    switch(isa)
+    {
+    case Isa::Avx512:
+        return "AVX-512";
+    case Isa::Avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
@@ -1,10 +1,17 @@
 #include "StreamManager.h"
+#include "ActivationCalibrator.h"
 #include "AudioModel.h"
 #include "Average.h"
 #include "BasicTypes.h"
-#include "HannFilter.h"
+#include "FrameProfiler.h"
+#include "ModelPackage.h"
+#include "ModelRegistry.h"
+#include "RateAdapter.h"
+#include "SharedModel.h"
+#include "SimdKernels.h"
 #include "WavReader.h"
 #include "util.h"
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
@@ -12,74 +19,200 @@
 #include <math.h>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace
 {
 using StreamManager = WS::StreamManager;
-} // namespace
 
-std::string StreamManager::getVersion()
+/// Activation and sample rate the models are prepared with.
+const std::string ModelActivation{"tanh"};
+constexpr u32 ModelSampleRate{48000U};
+
+/// Number of frames run per benchmark.
+constexpr u32 BenchFrameCnt{256U};
+
+/// Number of kernel calls timed per instruction set when benchmarking.
+constexpr u32 BenchKernelRuns{20000U};
+/// Thread counts of the single stream latency benchmark.
+constexpr u32 BenchThreadCnts[]{1U, 2U, 4U};
+/// Number of instances of the model opened through the registry when benchmarking.
+constexpr u32 BenchInstanceCnt{4U};
+
+/// Returns the "-pf" option value, clamped to [0.0, 1.0].
+float getParamValue(TL::LibCore::CmdLineParser& parser)
 {
-    std::string version{"0.0"};
-    std::ifstream ifs{"version.txt", std::ios_base::in};
-    if(ifs.is_open())
+    std::string paramValueStr;
+    parser.getValue("-pf", paramValueStr);
+    float pVal{std::stof(paramValueStr)};
+    if(pVal > 1.0F)
+        pVal = 1.0F;
+    else if(pVal < 0.0F)
+        pVal = 0.0F;
+    return pVal;
+}
+
+/// Returns the "-threads" option value, at least 1.
+u32 getNumThreads(TL::LibCore::CmdLineParser& parser)
+{
+    std::string numThreadsStr;
+    parser.getValue("-threads", numThreadsStr);
+    unsigned long const numThreads{std::stoul(numThreadsStr)};
+    return numThreads > 1 ? static_cast<u32>(numThreads) : 1U;
+}
+
+/// Returns whether the "-eq" option is set. The EQ keeps filter state from one model call to the next inside
+/// each model, so hops split over model replicas would each see a different EQ history: -threads is then ignored.
+bool hasEqOption(TL::LibCore::CmdLineParser& parser)
+{
+    std::string eqConfigFileName;
+    parser.getValue("-eq", eqConfigFileName);
+    return !eqConfigFileName.empty();
+}
+
+/// Number of samples per channel compared at once against the reference file.
+constexpr u64 CompareBlockSize{4096U};
+
+/// Outputs the stats of every profiled stage, one line per stage.
+void printProfile(WS::FrameProfiler const& profiler)
+{
+    std::cout << "Profile (ms): stage / calls / total / min / max / p50 / p99" << std::endl;
+    for(WS::FrameProfiler::SectionStats const& stats : profiler.getStats())
     {
-        char line[256];
-        ifs.read(line, 256);
-        ifs.close();
-        version = line;
+        std::cout << std::setw(14) << std::setfill(' ') << stats.name << " " << std::setw(8) << stats.callCnt
+                  << std::fixed << std::setprecision(3)
+                  << " " << std::setw(10) << stats.totalMs << " " << std::setw(8) << stats.minMs
+                  << " " << std::setw(8) << stats.maxMs << " " << std::setw(8) << stats.p50Ms
+                  << " " << std::setw(8) << stats.p99Ms << std::endl;
     }
-    return version;
 }
 
-int StreamManager::processFile(TL::LibCore::CmdLineParser& parser)
+/// Collects the layer values of every model call of a stream, and the time spent doing so.
+struct CalibrationTap
+{
+    WS::ActivationCalibrator& calibrator;
+    std::chrono::high_resolution_clock::duration duration{0};
+
+    static void collect(void* userData, WS::AudioModel& model)
+    {
+        CalibrationTap& tap{*static_cast<CalibrationTap*>(userData)};
+        auto start = std::chrono::high_resolution_clock::now();
+        tap.calibrator.collect(model);
+        tap.duration += std::chrono::high_resolution_clock::now() - start;
+    }
+};
+
+/// Applies the "-eq" and "-pf" options to a prepared model. Returns false, after reporting the error, on failure.
+bool applyModelSettings(WS::AudioModel& audioModel, TL::LibCore::CmdLineParser& parser)
 {
-    static const std::string ACTIVATION{"tanh"};
-    const unsigned int sr = 48000;
-    std::unique_ptr<AudioModel> audioModel{new AudioModel(ACTIVATION, sr)};
+    std::string eqConfigFileName;
+    parser.getValue("-eq", eqConfigFileName);
+    // The EQ runs inside the model, at its rate
+    if(!eqConfigFileName.empty() && !audioModel.loadJsonEQParameters(eqConfigFileName, ModelSampleRate))
+    {
+        std::string error{"Could not load-in the given EQ config file. Check config file name as -eq option."};
+        std::cout << "ERROR: " << error << std::endl;
+        return false;
+    }
+
+    size_t numOfParams{audioModel.getNumberOfParams()};
+    if(numOfParams > 0)
+    {
+        audioModel.setParamValueAt(0, getParamValue(parser));
+    }
+    return true;
+}
+
+/// Allocates and prepares the AudioModel given by the "-m" option, applying the "-eq" and "-pf" options.
+/// Returns nullptr, after reporting the error, on failure.
+std::unique_ptr<WS::AudioModel> createModel(TL::LibCore::CmdLineParser& parser)
+{
+    std::string modelName;
+    parser.getValue("-m", modelName);
+    std::unique_ptr<WS::AudioModel> audioModel{WS::ModelRegistry::prepareModel(modelName, ModelActivation, ModelSampleRate)};
     // audioModel->setLicense("Waveshaper AI");
     if(!audioModel)
     {
-        std::string error{"Could not allocate properly the AudioModel class."};
+        std::string error{"Could not prepare the model properly. Check model file name as -m option."};
         std::cout << "ERROR: " << error << std::endl;
-        return 1;
+        return nullptr;
     }
 
+    if(!applyModelSettings(*audioModel, parser))
+    {
+        return nullptr;
+    }
+    return audioModel;
+}
+
+/// Returns the shared AudioModel given by the "-m" option from the model registry, applying the "-eq" and "-pf" options.
+/// Returns nullptr, after reporting the error, on failure.
+std::shared_ptr<WS::SharedModel> acquireModel(TL::LibCore::CmdLineParser& parser)
+{
     std::string modelName;
     parser.getValue("-m", modelName);
-#ifdef OS_WINDOWS
-    modelName += "\\";
-#else
-    modelName += "/";
-#endif
-    if(!audioModel->prepare(modelName))
+    std::shared_ptr<WS::SharedModel> sharedModel{WS::ModelRegistry::getInstance().acquire(modelName, ModelActivation, ModelSampleRate)};
+    if(!sharedModel)
     {
         std::string error{"Could not prepare the model properly. Check model file name as -m option."};
         std::cout << "ERROR: " << error << std::endl;
-        return 1;
+        return nullptr;
     }
 
+    // The model may be shared with other holders: settings go through SharedModel, under its lock. The parameter
+    // only sets the default of the contexts created afterwards, each context applies its own values to the model.
     std::string eqConfigFileName;
     parser.getValue("-eq", eqConfigFileName);
-    if(!eqConfigFileName.empty() && !audioModel->loadJsonEQParameters(eqConfigFileName, 44100))
+    if(!eqConfigFileName.empty() && !sharedModel->loadJsonEQParameters(eqConfigFileName, ModelSampleRate))
     {
         std::string error{"Could not load-in the given EQ config file. Check config file name as -eq option."};
         std::cout << "ERROR: " << error << std::endl;
-        return 1;
+        return nullptr;
     }
+    if(sharedModel->getNumberOfParams() > 0)
+    {
+        sharedModel->setParamValueAt(0, getParamValue(parser));
+    }
+    return sharedModel;
+}
+} // namespace
 
-    size_t numOfParams{audioModel->getNumberOfParams()};
-    if(numOfParams > 0)
+std::string StreamManager::getVersion()
+{
+    std::string version{"0.0"};
+    std::ifstream ifs{"version.txt", std::ios_base::in};
+    if(ifs.is_open())
     {
-        std::string paramValueStr;
-        parser.getValue("-pf", paramValueStr);
-        float pVal{std::stof(paramValueStr)};
-        if(pVal > 1.0F)
-            pVal = 1.0F;
-        else if(pVal < 0.0F)
-            pVal = 0.0F;
+        char line[256];
+        ifs.read(line, 256);
+        ifs.close();
+        version = line;
+    }
+    return version;
+}
 
-        audioModel->setParamValueAt(0, pVal);
+int StreamManager::processFile(TL::LibCore::CmdLineParser& parser)
+{
+    std::shared_ptr<WS::SharedModel> registeredModel{acquireModel(parser)};
+    if(!registeredModel)
+    {
+        return 1;
+    }
+
+    // Both channels share the prepared model weights, each one keeps its own stream context.
+    WS::SharedModel& sharedModel{*registeredModel};
+
+    u32 numThreads{getNumThreads(parser)};
+    if(numThreads > 1 && hasEqOption(parser))
+    {
+        std::cout << "WARNING: -threads is ignored with -eq, the model calls run on a single thread." << std::endl;
+        numThreads = 1;
+    }
+    if(numThreads > 1 && !sharedModel.setNumThreads(numThreads, [&parser] { return createModel(parser); }))
+    {
+        std::string error{"Could not create the model replicas for the -threads option."};
+        std::cout << "ERROR: " << error << std::endl;
+        return 1;
     }
 
     WS::WavReader streamer;
@@ -118,67 +251,134 @@ int StreamManager::processFile(TL::LibCore::CmdLineParser& parser)
               << "\nBits Per Sample: " << bitsPerSample
               << std::endl;
 
-    u32 samplesBufferSize{static_cast<u32>(audioModel->getFrameLength())};
+    u32 samplesBufferSize{static_cast<u32>(sharedModel.getFrameLength())};
 
-    std::unique_ptr<float> bufferL{new float[samplesBufferSize]{0.0F}};
-    std::unique_ptr<float> bufferR{new float[samplesBufferSize]{0.0F}};
     bool fileCreated{false};
 
-    WS::HannFilter hannL{samplesBufferSize}, hannR{samplesBufferSize};
-    std::unique_ptr<float> chan0Output{new float[samplesBufferSize]{0.0F}};
-    std::unique_ptr<float> chan1Output{new float[samplesBufferSize]{0.0F}};
+    std::unique_ptr<WS::StreamContext> contextL{sharedModel.createContext()};
+    std::unique_ptr<WS::StreamContext> contextR{sharedModel.createContext()};
+    // The overlap-add delays the output by half a block
+    u32 const filterDelay{samplesBufferSize / 2};
     u64 outputSamples{0U};
     u64 totalSamples{streamer.getNumSamplesPerChannel()};
 
     TL::LibCore::Average<float> averager;
     float mean;
 
+    // Every model call of both channels is calibrated, outside of the block timing.
+    std::string calibFileName;
+    parser.getValue("-calib", calibFileName);
+    WS::ActivationCalibrator calibrator;
+    CalibrationTap calibrationTap{calibrator};
+    if(!calibFileName.empty())
+    {
+        contextL->setModelCallback(&CalibrationTap::collect, &calibrationTap);
+        contextR->setModelCallback(&CalibrationTap::collect, &calibrationTap);
+    }
+
     averager.init(totalSamples / 1000);
 
-    while(outputSamples < totalSamples)
+    bool const profiling{parser.hasSwitch("-prof")};
+    sharedModel.enableProfiling(profiling);
+    WS::FrameProfiler* profiler{&sharedModel.getProfiler()};
+
+    auto const processL = [&](float* dataSamples, float* outSamples) {
+        return sharedModel.process(*contextL, dataSamples, outSamples);
+    };
+    auto const processR = [&](float* dataSamples, float* outSamples) {
+        return sharedModel.process(*contextR, dataSamples, outSamples);
+    };
+
+    // The model runs at the rate it was trained at: files at other rates are resampled on the way in and out.
+    std::unique_ptr<WS::RateAdapter> rateAdapterL, rateAdapterR;
+    u32 outputDelay{filterDelay};
+    if(sampleRate != ModelSampleRate)
     {
+        rateAdapterL.reset(new WS::RateAdapter{sampleRate, ModelSampleRate, samplesBufferSize, filterDelay, processL});
+        rateAdapterR.reset(new WS::RateAdapter{sampleRate, ModelSampleRate, samplesBufferSize, filterDelay, processR});
+        outputDelay = rateAdapterL->getLatencySamples();
+        std::cout << "Resampling from " << sampleRate << " Hz to the model rate of " << ModelSampleRate << " Hz" << std::endl;
+    }
 
-        if(!streamer.getNextAudioBlock(bufferL.get(), 0, samplesBufferSize)) // on last call, reminder unused samples are set to 0
+    std::unique_ptr<float[]> bufferL{new float[samplesBufferSize]{0.0F}};
+    std::unique_ptr<float[]> bufferR{new float[samplesBufferSize]{0.0F}};
+    std::unique_ptr<float[]> chan0Output{new float[samplesBufferSize]{0.0F}};
+    std::unique_ptr<float[]> chan1Output{new float[samplesBufferSize]{0.0F}};
+
+    // Silent blocks are fed past the end of file to flush the samples still held by the overlap-add and the resamplers,
+    // so that the output ends at the input length whatever the rate.
+    u64 const flushSamples{outputDelay};
+    u64 samplesToSkip{outputDelay};
+    u64 readSamples{0U};
+    while(outputSamples < totalSamples)
+    {
+        if(readSamples >= totalSamples + flushSamples)
         {
             // Abort reading file.
             break;
         }
 
-        if(numChannels > 1)
+        if(readSamples >= totalSamples)
+        {
+            std::fill(bufferL.get(), bufferL.get() + samplesBufferSize, 0.0F);
+            std::fill(bufferR.get(), bufferR.get() + samplesBufferSize, 0.0F);
+        }
+        else
         {
-            if(!streamer.getNextAudioBlock(bufferR.get(), 1, samplesBufferSize))
+            WS::FrameProfiler::Scope timer{profiler, WS::FrameProfiler::Section::WavRead};
+            // on last call, reminder unused samples are set to 0
+            if(!streamer.getNextAudioBlock(bufferL.get(), 0, samplesBufferSize) ||
+               (numChannels > 1 && !streamer.getNextAudioBlock(bufferR.get(), 1, samplesBufferSize)))
             {
                 // Abort reading file.
                 break;
             }
         }
+        readSamples += samplesBufferSize;
 
         // Apply Hann Windowing and process using the AudioModel
 
+        auto const calibrationStart{calibrationTap.duration};
         auto start = std::chrono::high_resolution_clock::now();
 
-        hannL.applyFilter(bufferL.get(), samplesBufferSize, *audioModel, chan0Output.get());
+        bool success{rateAdapterL ? rateAdapterL->process(bufferL.get(), chan0Output.get())
+                                  : processL(bufferL.get(), chan0Output.get())};
 
         auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start - (calibrationTap.duration - calibrationStart)).count();
         averager.add(duration);
 
         if(numChannels > 1)
         {
-            hannR.applyFilter(bufferR.get(), samplesBufferSize, *audioModel, chan1Output.get());
+            success &= rateAdapterR ? rateAdapterR->process(bufferR.get(), chan1Output.get())
+                                    : processR(bufferR.get(), chan1Output.get());
         }
 
-        // due use of overlap-add, the first audio block will have a delay half samplesBufferSize
-        // then, we remove that delay by just writting the second half of the processed block
-        if(outputSamples == 0)
-            fileCreated &= streamer.writeToFile(chan0Output.get() + samplesBufferSize / 2,
-                (numChannels > 1) ? chan1Output.get() + samplesBufferSize / 2 : nullptr,
-                samplesBufferSize / 2);
-        else
-            fileCreated &= streamer.writeToFile(chan0Output.get(), (numChannels > 1) ? chan1Output.get() : nullptr, samplesBufferSize);
+        if(!success)
+        {
+            std::string error{"The model could not process a block of the file."};
+            std::cout << "ERROR: " << error << std::endl;
+            return 1;
+        }
+
+        // due use of overlap-add, and of the resamplers if any, the output has a delay of outputDelay samples (half samplesBufferSize without resampling)
+        // then, we remove that delay by skipping the first outputDelay processed samples. The flushed blocks end
+        // past the end of file: the output stops at the input length.
+        {
+            WS::FrameProfiler::Scope timer{profiler, WS::FrameProfiler::Section::WavWrite};
+            u32 const skippedSamples{static_cast<u32>(std::min<u64>(samplesToSkip, samplesBufferSize))};
+            samplesToSkip -= skippedSamples;
+            u64 const writtenSamples{streamer.getWrittenSamples()};
+            u32 const writeCnt{static_cast<u32>(std::min<u64>(samplesBufferSize - skippedSamples,
+                writtenSamples < totalSamples ? totalSamples - writtenSamples : 0U))};
+            if(writeCnt > 0)
+                fileCreated &= streamer.writeToFile(chan0Output.get() + skippedSamples,
+                    (numChannels > 1) ? chan1Output.get() + skippedSamples : nullptr,
+                    writeCnt);
+        }
 
         // Show completion
-        outputSamples = streamer.getWrittenSamples() + samplesBufferSize / 2;
+        outputSamples = streamer.getWrittenSamples();
 
         float completion{(static_cast<float>(outputSamples) / static_cast<float>(totalSamples)) * 100.F};
 
@@ -187,6 +387,23 @@ int StreamManager::processFile(TL::LibCore::CmdLineParser& parser)
         std::cout.flush();
     }
 
+    if(!calibFileName.empty())
+    {
+        std::ofstream calibFile{calibFileName};
+        if(!calibFile.is_open())
+        {
+            std::cout << "ERROR: Could not create the calibration report: " << calibFileName << std::endl;
+            return 1;
+        }
+        calibrator.writeReport(calibFile);
+        std::cout << "Calibration report written to: " << calibFileName << std::endl;
+    }
+
+    if(profiling)
+    {
+        printProfile(*profiler);
+    }
+
     mean = averager.computeMean();
 
     std::cout << "Completion: " << std::fixed << std::setprecision(2)
@@ -195,3 +412,186 @@ int StreamManager::processFile(TL::LibCore::CmdLineParser& parser)
 
     return 0;
 }
+
+int StreamManager::packModel(TL::LibCore::CmdLineParser& parser)
+{
+    std::string modelName, packageName;
+    parser.getValue("-m", modelName);
+    parser.getValue("-pack", packageName);
+    if(!WS::ModelPackage::pack(modelName, packageName))
+    {
+        std::string error{"Could not pack the model folder given as -m option into: "};
+        error += packageName;
+        std::cout << "ERROR: " << error << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed model written to: " << packageName << std::endl;
+    return 0;
+}
+
+int StreamManager::benchmarkModel(TL::LibCore::CmdLineParser& parser)
+{
+    std::unique_ptr<AudioModel> audioModel{createModel(parser)};
+    if(!audioModel)
+    {
+        return 1;
+    }
+
+    WS::WavReader streamer;
+    std::string inWavPathName;
+    parser.getValue("inputFileWAV", inWavPathName);
+    if(!streamer.load(inWavPathName))
+    {
+        std::string error{"Could not load the given file for input: "};
+        error += inWavPathName;
+        std::cout << "ERROR: " << error << std::endl;
+        return 1;
+    }
+
+    // Fill the benchmark frames with the file content, channel 0 only; frames past the end of file stay silent.
+    size_t const frameLength{audioModel->getFrameLength()};
+    u32 const samplesBufferSize{static_cast<u32>(frameLength)};
+    u64 const totalSamples{streamer.getNumSamplesPerChannel()};
+    std::vector<float> frames(BenchFrameCnt * frameLength, 0.0F);
+    std::vector<float> scratchR(frameLength, 0.0F);
+    std::vector<float> outFrames(BenchFrameCnt * frameLength, 0.0F);
+    for(u32 f = 0; f < BenchFrameCnt && static_cast<u64>(f) * frameLength < totalSamples; f++)
+    {
+        if(!streamer.getNextAudioBlock(frames.data() + f * frameLength, 0, samplesBufferSize))
+            break;
+        if(streamer.getNumberOfChannels() > 1 && !streamer.getNextAudioBlock(scratchR.data(), 1, samplesBufferSize))
+            break;
+    }
+
+    // Windowing / overlap-add kernel of the HannFilter, for each instruction set the CPU supports.
+    std::cout << "Benchmarking overlap-add kernels on " << frameLength << " samples, detected: "
+              << WS::Simd::getIsaName(WS::Simd::detectIsa()) << std::endl;
+    std::vector<float> window(frameLength, 0.5F);
+    double scalarSeconds{0.0};
+    for(WS::Simd::Isa isa : {WS::Simd::Isa::Scalar, WS::Simd::Isa::Avx2, WS::Simd::Isa::Avx512})
+    {
+        if(isa > WS::Simd::detectIsa())
+            break;
+
+        WS::Simd::MultiplyAddFunc multiplyAdd{WS::Simd::getMultiplyAdd(isa)};
+        auto start = std::chrono::high_resolution_clock::now();
+        for(u32 r = 0; r < BenchKernelRuns; r++)
+        {
+            multiplyAdd(outFrames.data(), frames.data() + (r % BenchFrameCnt) * frameLength, window.data(), samplesBufferSize);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double seconds{std::chrono::duration<double>(end - start).count()};
+        if(isa == WS::Simd::Isa::Scalar)
+            scalarSeconds = seconds;
+        std::cout << std::setw(8) << std::setfill(' ') << WS::Simd::getIsaName(isa) << ": "
+                  << std::fixed << std::setprecision(1) << (seconds * 1.0e9 / BenchKernelRuns) << " ns/call, speedup "
+                  << std::setprecision(2) << (scalarSeconds / seconds) << "x" << std::endl;
+    }
+
+    WS::SharedModel sharedModel{std::move(audioModel)};
+    if(sharedModel.getNumberOfParams() > 0)
+    {
+        sharedModel.setParamValueAt(0, getParamValue(parser));
+    }
+
+    // A single stream with its model calls split over the pool threads: only the hops of one block run in parallel.
+    std::cout << "Benchmarking single stream block latency, " << frameLength << " samples per block" << std::endl;
+    for(u32 threadCnt : BenchThreadCnts)
+    {
+        if(threadCnt > 1 && hasEqOption(parser))
+            break;
+        if(!sharedModel.setNumThreads(threadCnt, [&parser] { return createModel(parser); }))
+            return 1;
+
+        std::unique_ptr<WS::StreamContext> context{sharedModel.createContext()};
+        double totalSeconds{0.0};
+        double maxSeconds{0.0};
+        for(u32 f = 0; f < BenchFrameCnt; f++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            sharedModel.process(*context, frames.data() + f * frameLength, outFrames.data() + f * frameLength);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            double const seconds{std::chrono::duration<double>(end - start).count()};
+            totalSeconds += seconds;
+            maxSeconds = std::max(maxSeconds, seconds);
+        }
+        std::cout << "Threads " << threadCnt << ": mean " << std::fixed << std::setprecision(1)
+                  << (totalSeconds * 1.0e6 / BenchFrameCnt) << " us, max " << (maxSeconds * 1.0e6) << " us per block" << std::endl;
+    }
+
+    // Instances of the same model opened through the registry: only the first one prepares it.
+    std::string modelName;
+    parser.getValue("-m", modelName);
+    std::vector<std::shared_ptr<WS::SharedModel>> instances;
+    std::cout << "Benchmarking " << BenchInstanceCnt << " instances opened through the model registry" << std::endl;
+    for(u32 i = 0; i < BenchInstanceCnt; i++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        instances.push_back(WS::ModelRegistry::getInstance().acquire(modelName, ModelActivation, ModelSampleRate));
+        auto end = std::chrono::high_resolution_clock::now();
+        if(!instances.back())
+            return 1;
+
+        std::cout << "Instance " << i << ": " << std::fixed << std::setprecision(1)
+                  << (std::chrono::duration<double>(end - start).count() * 1.0e6) << " us" << std::endl;
+    }
+    std::cout << "Models alive: " << WS::ModelRegistry::getInstance().getModelCnt() << std::endl;
+
+    return 0;
+}
+
+int StreamManager::compareToReference(TL::LibCore::CmdLineParser& parser)
+{
+    std::string outWavPathName, refWavPathName;
+    parser.getValue("outputFileWAV", outWavPathName);
+    parser.getValue("-ref", refWavPathName);
+
+    WS::WavReader output, reference;
+    if(!output.load(outWavPathName) || !reference.load(refWavPathName))
+    {
+        std::cout << "ERROR: Could not load " << outWavPathName << " or reference " << refWavPathName << std::endl;
+        return 1;
+    }
+    if(output.getNumberOfChannels() != reference.getNumberOfChannels())
+    {
+        std::cout << "ERROR: Output and reference files do not have the same number of channels." << std::endl;
+        return 1;
+    }
+
+    int const numChannels{output.getNumberOfChannels()};
+    u64 const totalSamples{std::min(output.getNumSamplesPerChannel(), reference.getNumSamplesPerChannel())};
+    if(totalSamples == 0)
+    {
+        std::cout << "ERROR: Output or reference file holds no samples." << std::endl;
+        return 1;
+    }
+    u32 const blockSize{static_cast<u32>(std::min<u64>(CompareBlockSize, totalSamples))};
+    std::vector<float> outBlock(blockSize), refBlock(blockSize);
+
+    // Sums in double: files hold millions of samples.
+    double signalEnergy{0.0}, noiseEnergy{0.0};
+    for(u64 done = 0; done + blockSize <= totalSamples; done += blockSize)
+    {
+        for(int ch = 0; ch < numChannels; ch++)
+        {
+            output.getNextAudioBlock(outBlock.data(), ch, blockSize);
+            reference.getNextAudioBlock(refBlock.data(), ch, blockSize);
+            for(u32 s = 0; s < blockSize; s++)
+            {
+                double const diff{static_cast<double>(outBlock[s]) - refBlock[s]};
+                signalEnergy += static_cast<double>(refBlock[s]) * refBlock[s];
+                noiseEnergy += diff * diff;
+            }
+        }
+    }
+
+    std::cout << "Reference: " << refWavPathName << std::endl;
+    if(noiseEnergy == 0.0)
+        std::cout << "SNR: identical to reference" << std::endl;
+    else
+        std::cout << "SNR: " << std::fixed << std::setprecision(2) << 10.0 * std::log10(signalEnergy / noiseEnergy) << " dB" << std::endl;
+    return 0;
+}
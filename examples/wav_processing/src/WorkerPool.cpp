@@ -0,0 +1,135 @@
+#include "WorkerPool.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+using WorkerPool = WS::WorkerPool;
+
+/// Number of polls before a waiting thread parks, a few microseconds on current CPUs.
+/// Spinning is skipped on single core machines, where it would only delay the thread being waited for.
+constexpr u32 SpinCnt{4000U};
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+} // namespace
+
+WorkerPool::WorkerPool(u32 const numThreads) : mNumThreads{numThreads > 0 ? numThreads : 1U},
+                                               mSpinCnt{std::thread::hardware_concurrency() > 1 ? SpinCnt : 0U}
+{
+    for(u32 t = 1; t < mNumThreads; t++)
+    {
+        mWorkers.emplace_back(&WorkerPool::workerLoop, this, t);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    mStop.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock{mParkMutex};
+    }
+    mWorkReady.notify_all();
+    for(std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(u32 taskCnt, Task task, void* userData)
+{
+    if(mWorkers.empty() || taskCnt < 2)
+    {
+        for(u32 t = 0; t < taskCnt; t++)
+        {
+            task(userData, t, 0);
+        }
+        return;
+    }
+
+    mTask = task;
+    mUserData = userData;
+    mTaskCnt = taskCnt;
+    mNextTask.store(0, std::memory_order_relaxed);
+    mBusyWorkers.store(static_cast<u32>(mWorkers.size()), std::memory_order_relaxed);
+    mGeneration.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders the publication against a worker about to park.
+    {
+        std::lock_guard<std::mutex> lock{mParkMutex};
+    }
+    mWorkReady.notify_all();
+
+    runTasks(0);
+
+    for(u32 spin = 0; spin < mSpinCnt; spin++)
+    {
+        if(mBusyWorkers.load(std::memory_order_acquire) == 0)
+        {
+            return;
+        }
+        cpuRelax();
+    }
+    std::unique_lock<std::mutex> lock{mParkMutex};
+    mWorkDone.wait(lock, [this] { return mBusyWorkers.load(std::memory_order_acquire) == 0; });
+}
+
+u32 WorkerPool::getNumThreads() const
+{
+    return mNumThreads;
+}
+
+void WorkerPool::workerLoop(u32 threadIdx)
+{
+    u64 seenGeneration{0};
+    while(true)
+    {
+        u64 generation{mGeneration.load(std::memory_order_acquire)};
+        for(u32 spin = 0; spin < mSpinCnt && generation == seenGeneration && !mStop.load(std::memory_order_acquire); spin++)
+        {
+            cpuRelax();
+            generation = mGeneration.load(std::memory_order_acquire);
+        }
+
+        if(generation == seenGeneration)
+        {
+            std::unique_lock<std::mutex> lock{mParkMutex};
+            mWorkReady.wait(lock, [this, seenGeneration] {
+                return mStop.load(std::memory_order_acquire) || mGeneration.load(std::memory_order_acquire) != seenGeneration;
+            });
+            generation = mGeneration.load(std::memory_order_acquire);
+        }
+
+        if(mStop.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        seenGeneration = generation;
+        runTasks(threadIdx);
+
+        if(mBusyWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mParkMutex};
+            }
+            mWorkDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runTasks(u32 threadIdx)
+{
+    for(u32 t = mNextTask.fetch_add(1, std::memory_order_relaxed); t < mTaskCnt; t = mNextTask.fetch_add(1, std::memory_order_relaxed))
+    {
+        mTask(mUserData, t, threadIdx);
+    }
+}
@@ -13,13 +13,32 @@ int main(int argc, char* argv[])
     TL::LibCore::CmdLineParser parser;
     parser.addArgument("inputFileWAV", "is the full path and name of the file to process. It is a .wav file.");
     parser.addArgument("outputFileWAV", "is the full path and name of the processed file name to output. It is a .wav file.");
-    parser.addOption("-m", "data/PodcastFix_V1", "is the name of the model folder, as found in the output/data folder.");
+    parser.addOption("-m", "data/PodcastFix_V1", "is the name of the model folder, as found in the output/data folder, or of a packed model file.");
     parser.addOption("-eq", "", "is the name of the JSON config file for optional EQ filtering.");
     parser.addOption("-pf", "0.0", "is the value of the parameter of the model.");
+    parser.addOption("-calib", "", "is the name of the activation calibration report to write while processing.");
+    parser.addOption("-ref", "", "is the name of a reference .wav file to compute the output SNR against.");
+    parser.addOption("-pack", "", "is the name of the packed model file to write from the -m model folder, instead of processing.");
+    parser.addOption("-threads", "1", "is the number of threads splitting the model calls of each block, one model copy per thread, ignored with -eq.");
+    parser.addSwitch("-prof", "reports call counts and timings of every processing stage once the file is processed.");
+    parser.addSwitch("-bench", "reports kernel, thread and model registry timings instead of writing the output file.");
     if(parser.validateCmdLine(argc, (char const**)argv))
     {
         parser.showParameterValues("All given values at cmd line:");
-        retValue = WS::StreamManager::processFile(parser);
+        std::string packageName;
+        parser.getValue("-pack", packageName);
+        if(!packageName.empty())
+            return WS::StreamManager::packModel(parser);
+
+        if(parser.hasSwitch("-bench"))
+            retValue = WS::StreamManager::benchmarkModel(parser);
+        else
+            retValue = WS::StreamManager::processFile(parser);
+
+        std::string refWavPathName;
+        parser.getValue("-ref", refWavPathName);
+        if(retValue == 0 && !refWavPathName.empty() && !parser.hasSwitch("-bench"))
+            retValue = WS::StreamManager::compareToReference(parser);
         return retValue;
     }
     return 1;